@@ -161,6 +161,7 @@ fi
 %dir %{_libdir}/%{name}/plugins/
 
 # Core plugins
+%{_libdir}/%{name}/plugins/libbinary.so
 %{_libdir}/%{name}/plugins/libcsv.so
 %{_libdir}/%{name}/plugins/libjson.so
 %{_libdir}/%{name}/plugins/liblua.so
@@ -32,6 +32,8 @@
 #include "tile.h"
 #include "tileset.h"
 
+#include <QtEndian>
+
 using namespace Tiled;
 
 // Bits on the far end of the 32-bit global tile ID are used for tile flags
@@ -39,6 +41,18 @@ const int FlippedHorizontallyFlag   = 0x80000000;
 const int FlippedVerticallyFlag     = 0x40000000;
 const int FlippedAntiDiagonallyFlag = 0x20000000;
 
+static unsigned gidWithFlags(unsigned gid, const Cell &cell)
+{
+    if (cell.flippedHorizontally)
+        gid |= FlippedHorizontallyFlag;
+    if (cell.flippedVertically)
+        gid |= FlippedVerticallyFlag;
+    if (cell.flippedAntiDiagonally)
+        gid |= FlippedAntiDiagonallyFlag;
+
+    return gid;
+}
+
 /**
  * Default constructor. Use \l insert to initialize the gid mapper
  * incrementally.
@@ -112,26 +126,59 @@ unsigned GidMapper::cellToGid(const Cell &cell) const
     if (cell.isEmpty())
         return 0;
 
-    const Tileset *tileset = cell.tile->tileset();
+    const unsigned first = firstGid(cell.tile->tileset());
+    if (first == 0) // tileset not found
+        return 0;
+
+    return gidWithFlags(first + cell.tile->id(), cell);
+}
+
+/**
+ * Returns the global tile IDs of all cells in the given \a tileLayer, row
+ * by row. Empty cells and cells referring to unknown tilesets get a 0.
+ *
+ * This is much faster than calling cellToGid() for each cell, since the
+ * tileset is only looked up when it differs from the one of the previous
+ * cell.
+ */
+QVector<unsigned> GidMapper::layerGids(const TileLayer &tileLayer) const
+{
+    QVector<unsigned> gids(tileLayer.width() * tileLayer.height());
+    unsigned *gid = gids.data();
+
+    const Tileset *lastTileset = nullptr;
+    unsigned first = 0;
+
+    for (const Cell &cell : tileLayer) {
+        if (cell.isEmpty()) {
+            *gid++ = 0;
+            continue;
+        }
+
+        const Tileset *tileset = cell.tile->tileset();
+        if (tileset != lastTileset) {
+            lastTileset = tileset;
+            first = firstGid(tileset);
+        }
 
-    // Find the first GID for the tileset
+        *gid++ = first == 0 ? 0 : gidWithFlags(first + cell.tile->id(), cell);
+    }
+
+    return gids;
+}
+
+/**
+ * Returns the first global tile ID of the given \a tileset, or 0 when the
+ * tileset isn't known.
+ */
+unsigned GidMapper::firstGid(const Tileset *tileset) const
+{
     QMap<unsigned, Tileset*>::const_iterator i = mFirstGidToTileset.begin();
     QMap<unsigned, Tileset*>::const_iterator i_end = mFirstGidToTileset.end();
     while (i != i_end && i.value() != tileset)
         ++i;
 
-    if (i == i_end) // tileset not found
-        return 0;
-
-    unsigned gid = i.key() + cell.tile->id();
-    if (cell.flippedHorizontally)
-        gid |= FlippedHorizontallyFlag;
-    if (cell.flippedVertically)
-        gid |= FlippedVerticallyFlag;
-    if (cell.flippedAntiDiagonally)
-        gid |= FlippedAntiDiagonallyFlag;
-
-    return gid;
+    return i == i_end ? 0 : i.key();
 }
 
 /**
@@ -145,17 +192,14 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
 
-    QByteArray tileData;
-    tileData.reserve(tileLayer.height() * tileLayer.width() * 4);
+    const QVector<unsigned> gids = layerGids(tileLayer);
 
-    for (int y = 0; y < tileLayer.height(); ++y) {
-        for (int x = 0; x < tileLayer.width(); ++x) {
-            const unsigned gid = cellToGid(tileLayer.cellAt(x, y));
-            tileData.append((char) (gid));
-            tileData.append((char) (gid >> 8));
-            tileData.append((char) (gid >> 16));
-            tileData.append((char) (gid >> 24));
-        }
+    QByteArray tileData(gids.size() * 4, Qt::Uninitialized);
+    uchar *data = reinterpret_cast<uchar*>(tileData.data());
+
+    for (unsigned gid : gids) {
+        qToLittleEndian<quint32>(gid, data);
+        data += 4;
     }
 
     if (format == Map::Base64Gzip)
@@ -51,6 +51,7 @@ public:
 
     Cell gidToCell(unsigned gid, bool &ok) const;
     unsigned cellToGid(const Cell &cell) const;
+    QVector<unsigned> layerGids(const TileLayer &tileLayer) const;
 
     QByteArray encodeLayerData(const TileLayer &tileLayer,
                                Map::LayerDataFormat format) const;
@@ -69,6 +70,8 @@ public:
     unsigned invalidTile() const;
 
 private:
+    unsigned firstGid(const Tileset *tileset) const;
+
     QMap<unsigned, Tileset*> mFirstGidToTileset;
 
     mutable unsigned mInvalidTile;
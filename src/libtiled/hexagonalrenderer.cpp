@@ -290,7 +290,7 @@ void HexagonalRenderer::drawTileLayer(QPainter *painter,
     if (inLeftHalf)
         startTile.rx()--;
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, flatColorTileSize());
 
     if (p.staggerX) {
         startTile.setX(qMax(-1, startTile.x()));
@@ -369,15 +369,14 @@ void HexagonalRenderer::drawTileSelection(QPainter *painter,
     painter->setBrush(color);
     painter->setPen(Qt::NoPen);
 
-    foreach (const QRect &r, region.rects()) {
-        for (int y = r.top(); y <= r.bottom(); ++y) {
-            for (int x = r.left(); x <= r.right(); ++x) {
-                const QPolygonF polygon = tileToScreenPolygon(x, y);
-                if (QRectF(polygon.boundingRect()).intersects(exposed))
-                    painter->drawConvexPolygon(polygon);
-            }
-        }
-    }
+    // Only visit the tiles that may be exposed, since large selections
+    // would otherwise take a polygon for each selected tile
+    const QRegion exposedRegion = exposedTileRegion(region, exposed);
+
+    foreach (const QRect &r, exposedRegion.rects())
+        for (int y = r.top(); y <= r.bottom(); ++y)
+            for (int x = r.left(); x <= r.right(); ++x)
+                painter->drawConvexPolygon(tileToScreenPolygon(x, y));
 }
 
 QPointF HexagonalRenderer::tileToPixelCoords(qreal x, qreal y) const
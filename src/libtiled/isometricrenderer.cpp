@@ -226,7 +226,7 @@ void IsometricRenderer::drawTileLayer(QPainter *painter,
     // Determine whether the current row is shifted half a tile to the right
     bool shifted = inUpperHalf ^ inLeftHalf;
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, flatColorTileSize());
 
     for (int y = startPos.y() * 2; y - tileHeight * 2 < rect.bottom() * 2;
          y += tileHeight)
@@ -267,11 +267,8 @@ void IsometricRenderer::drawTileSelection(QPainter *painter,
 {
     painter->setBrush(color);
     painter->setPen(Qt::NoPen);
-    foreach (const QRect &r, region.rects()) {
-        QPolygonF polygon = tileRectToScreenPolygon(r);
-        if (QRectF(polygon.boundingRect()).intersects(exposed))
-            painter->drawConvexPolygon(polygon);
-    }
+    foreach (const QRect &r, exposedTileRegion(region, exposed).rects())
+        painter->drawConvexPolygon(tileRectToScreenPolygon(r));
 }
 
 void IsometricRenderer::drawMapObject(QPainter *painter,
@@ -0,0 +1,164 @@
+/*
+ * layerexport.cpp
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "layerexport.h"
+
+#include "tile.h"
+#include "tilelayer.h"
+
+using namespace Tiled;
+
+// The same flags as used by GidMapper
+static const unsigned FlipFlags = 0xE0000000;
+
+/**
+ * Returns the IDs of the tiles of all cells in the given \a tileLayer, row by
+ * row. Empty cells get the given \a emptyId.
+ *
+ * Note that tile IDs are only unique within a tileset.
+ */
+QVector<int> Tiled::layerTileIds(const TileLayer &tileLayer, int emptyId)
+{
+    QVector<int> ids(tileLayer.width() * tileLayer.height());
+    int *id = ids.data();
+
+    for (const Cell &cell : tileLayer)
+        *id++ = cell.isEmpty() ? emptyId : cell.tile->id();
+
+    return ids;
+}
+
+
+/**
+ * Creates a table for the given \a tilesets, using the \a text function
+ * to determine the text for each tile and \a emptyText for empty cells.
+ */
+GidTextTable::GidTextTable(const QVector<SharedTileset> &tilesets,
+                           std::function<QByteArray (const Tile *)> text,
+                           const QByteArray &emptyText)
+{
+    unsigned firstGid = 1;
+    for (const SharedTileset &tileset : tilesets)
+        firstGid += tileset->nextTileId();
+
+    mTexts.resize(firstGid);
+    mTexts[0] = emptyText;
+
+    firstGid = 1;
+    for (const SharedTileset &tileset : tilesets) {
+        for (int id = 0; id < tileset->nextTileId(); ++id) {
+            if (const Tile *tile = tileset->findTile(id))
+                mTexts[firstGid + id] = text(tile);
+            else
+                mTexts[firstGid + id] = QByteArray::number(id);
+        }
+        firstGid += tileset->nextTileId();
+    }
+}
+
+/**
+ * Returns the text for the given \a gid. Unknown global tile IDs are
+ * written as empty cells.
+ */
+const QByteArray &GidTextTable::text(unsigned gid) const
+{
+    gid &= ~FlipFlags;
+    if (gid >= unsigned(mTexts.size()))
+        gid = 0;
+    return mTexts.at(gid);
+}
+
+
+RowFormatter::RowFormatter(char separator)
+    : mSeparator(separator)
+{
+}
+
+/**
+ * Appends the given \a values, separated by the separator. No separator or
+ * newline is added at the end.
+ */
+void RowFormatter::appendRow(const int *values, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            mBuffer.append(mSeparator);
+
+        const int value = values[i];
+        if (value < 0) {
+            mBuffer.append('-');
+            appendNumber(0u - unsigned(value));
+        } else {
+            appendNumber(unsigned(value));
+        }
+    }
+}
+
+/**
+ * \overload
+ */
+void RowFormatter::appendRow(const unsigned *values, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            mBuffer.append(mSeparator);
+        appendNumber(values[i]);
+    }
+}
+
+/**
+ * Appends the text for each of the given \a gids, as looked up in the
+ * given \a table.
+ */
+void RowFormatter::appendRow(const unsigned *gids, int count,
+                             const GidTextTable &table)
+{
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            mBuffer.append(mSeparator);
+        mBuffer.append(table.text(gids[i]));
+    }
+}
+
+void RowFormatter::appendNumber(unsigned value)
+{
+    char digits[10];
+    int length = 0;
+
+    do {
+        digits[length++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    const int size = mBuffer.size();
+    mBuffer.resize(size + length);
+
+    char *out = mBuffer.data() + size;
+    while (length)
+        *out++ = digits[--length];
+}
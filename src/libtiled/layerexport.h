@@ -0,0 +1,96 @@
+/*
+ * layerexport.h
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TILED_LAYEREXPORT_H
+#define TILED_LAYEREXPORT_H
+
+#include "tiled_global.h"
+#include "tileset.h"
+
+#include <QByteArray>
+#include <QVector>
+
+#include <functional>
+
+namespace Tiled {
+
+class TileLayer;
+
+TILEDSHARED_EXPORT QVector<int> layerTileIds(const TileLayer &tileLayer,
+                                             int emptyId = -1);
+
+/**
+ * A lookup table from global tile IDs to the text that should be written
+ * for each tile, for formats that write something else than the global tile
+ * ID, like the name of the tile.
+ *
+ * The global tile IDs are assigned the same way as by the GidMapper
+ * constructor that takes a list of tilesets. The flipping flags are ignored.
+ */
+class TILEDSHARED_EXPORT GidTextTable
+{
+public:
+    GidTextTable(const QVector<SharedTileset> &tilesets,
+                 std::function<QByteArray (const Tile *tile)> text,
+                 const QByteArray &emptyText);
+
+    const QByteArray &text(unsigned gid) const;
+
+private:
+    QVector<QByteArray> mTexts;
+};
+
+/**
+ * Formats rows of values as text into a buffer that is reused between rows,
+ * avoiding the overhead of streaming each value separately.
+ */
+class TILEDSHARED_EXPORT RowFormatter
+{
+public:
+    explicit RowFormatter(char separator = ',');
+
+    void appendRow(const int *values, int count);
+    void appendRow(const unsigned *values, int count);
+    void appendRow(const unsigned *gids, int count, const GidTextTable &table);
+
+    void append(char c) { mBuffer.append(c); }
+    void append(const char *text) { mBuffer.append(text); }
+
+    const QByteArray &buffer() const { return mBuffer; }
+    void clear() { mBuffer.resize(0); }
+
+private:
+    void appendNumber(unsigned value);
+
+    const char mSeparator;
+    QByteArray mBuffer;
+};
+
+} // namespace Tiled
+
+#endif // TILED_LAYEREXPORT_H
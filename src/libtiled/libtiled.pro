@@ -31,6 +31,7 @@ SOURCES += compression.cpp \
     imagereference.cpp \
     isometricrenderer.cpp \
     layer.cpp \
+    layerexport.cpp \
     map.cpp \
     mapobject.cpp \
     mapreader.cpp \
@@ -42,8 +43,10 @@ SOURCES += compression.cpp \
     plugin.cpp \
     pluginmanager.cpp \
     properties.cpp \
+    savejournal.cpp \
     staggeredrenderer.cpp \
     tile.cpp \
+    tileblitter.cpp \
     tilelayer.cpp \
     tileset.cpp \
     tilesetformat.cpp \
@@ -55,6 +58,7 @@ HEADERS += compression.h \
     imagereference.h \
     isometricrenderer.h \
     layer.h \
+    layerexport.h \
     logginginterface.h \
     map.h \
     mapformat.h \
@@ -69,9 +73,11 @@ HEADERS += compression.h \
     plugin.h \
     pluginmanager.h \
     properties.h \
+    savejournal.h \
     staggeredrenderer.h \
     terrain.h \
     tile.h \
+    tileblitter.h \
     tiled.h \
     tiled_global.h \
     tilelayer.h \
@@ -122,6 +122,13 @@ public:
      *         occurred. The error can be retrieved by errorString().
      */
     virtual bool write(const Map *map, const QString &fileName) = 0;
+
+    /**
+     * Returns a new instance of this format, or null when the format can't
+     * be instantiated more than once. Separate instances can be used to
+     * write maps from multiple threads at the same time.
+     */
+    virtual MapFormat *clone() const { return nullptr; }
 };
 
 } // namespace Tiled
@@ -36,6 +36,7 @@
 #include "objectgroup.h"
 #include "map.h"
 #include "mapobject.h"
+#include "savejournal.h"
 #include "tile.h"
 #include "tilelayer.h"
 #include "tilesetformat.h"
@@ -45,6 +46,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QSet>
 #include <QVector>
 #include <QXmlStreamReader>
 
@@ -112,6 +114,8 @@ private:
     Properties readProperties();
     void readProperty(Properties *properties);
 
+    QString intern(const QString &string);
+
     MapReader *p;
 
     QString mError;
@@ -119,6 +123,7 @@ private:
     QScopedPointer<Map> mMap;
     GidMapper mGidMapper;
     bool mReadingExternalTileset;
+    QSet<QString> mInternedStrings;
 
     QXmlStreamReader xml;
 };
@@ -804,7 +809,7 @@ MapObject *MapReaderPrivate::readObject()
     const qreal y = atts.value(QLatin1String("y")).toDouble();
     const qreal width = atts.value(QLatin1String("width")).toDouble();
     const qreal height = atts.value(QLatin1String("height")).toDouble();
-    const QString type = atts.value(QLatin1String("type")).toString();
+    const QString type = intern(atts.value(QLatin1String("type")).toString());
     const QStringRef visibleRef = atts.value(QLatin1String("visible"));
 
     const QPointF pos(x, y);
@@ -927,7 +932,7 @@ void MapReaderPrivate::readProperty(Properties *properties)
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("property"));
 
     const QXmlStreamAttributes atts = xml.attributes();
-    QString propertyName = atts.value(QLatin1String("name")).toString();
+    QString propertyName = intern(atts.value(QLatin1String("name")).toString());
     QString propertyValue = atts.value(QLatin1String("value")).toString();
     QString propertyType = atts.value(QLatin1String("type")).toString();
 
@@ -956,6 +961,16 @@ void MapReaderPrivate::readProperty(Properties *properties)
     properties->insert(propertyName, variant);
 }
 
+/**
+ * Returns a copy of \a string that shares its data with any equal string
+ * returned before. Used for property names and object types, which tend to
+ * be repeated a lot.
+ */
+QString MapReaderPrivate::intern(const QString &string)
+{
+    return *mInternedStrings.insert(string);
+}
+
 
 MapReader::MapReader()
     : d(new MapReaderPrivate(this))
@@ -978,7 +993,16 @@ Map *MapReader::readMap(const QString &fileName)
     if (!d->openFile(&file))
         return nullptr;
 
-    return readMap(&file, QFileInfo(fileName).absolutePath());
+    Map *map = readMap(&file, QFileInfo(fileName).absolutePath());
+    if (!map)
+        return nullptr;
+
+    if (!SaveJournal::replay(fileName, map, &d->mError)) {
+        delete map;
+        return nullptr;
+    }
+
+    return map;
 }
 
 SharedTileset MapReader::readTileset(QIODevice *device, const QString &path)
@@ -68,7 +68,8 @@ public:
     Map *readMap(QIODevice *device, const QString &path = QString());
 
     /**
-     * Reads a TMX map from the given \a fileName.
+     * Reads a TMX map from the given \a fileName. When there is a save
+     * journal next to the file, it is replayed on top of the map.
      * \overload
      */
     Map *readMap(const QString &fileName);
@@ -35,6 +35,7 @@
 #include <QPaintEngine>
 #include <QPainter>
 #include <QVector2D>
+#include <QtMath>
 
 using namespace Tiled;
 
@@ -81,6 +82,38 @@ QPolygonF MapRenderer::lineToPolygon(const QPointF &start, const QPointF &end)
     return polygon;
 }
 
+QRegion MapRenderer::exposedTileRegion(const QRegion &region,
+                                       const QRectF &exposed) const
+{
+    if (exposed.isNull())
+        return region;
+
+    const QPointF corners[4] = {
+        screenToTileCoords(exposed.topLeft()),
+        screenToTileCoords(exposed.topRight()),
+        screenToTileCoords(exposed.bottomLeft()),
+        screenToTileCoords(exposed.bottomRight())
+    };
+
+    qreal left = corners[0].x();
+    qreal top = corners[0].y();
+    qreal right = left;
+    qreal bottom = top;
+
+    for (const QPointF &corner : corners) {
+        left = qMin(left, corner.x());
+        top = qMin(top, corner.y());
+        right = qMax(right, corner.x());
+        bottom = qMax(bottom, corner.y());
+    }
+
+    // Include a margin for tiles which are only partially exposed
+    const QRect tileRect(QPoint(qFloor(left) - 1, qFloor(top) - 1),
+                         QPoint(qCeil(right) + 1, qCeil(bottom) + 1));
+
+    return region.intersected(tileRect);
+}
+
 
 static bool hasOpenGLEngine(const QPainter *painter)
 {
@@ -89,11 +122,40 @@ static bool hasOpenGLEngine(const QPainter *painter)
             type == QPaintEngine::OpenGL2);
 }
 
-CellRenderer::CellRenderer(QPainter *painter)
+CellRenderer::CellRenderer(QPainter *painter, qreal flatColorTileSize)
     : mPainter(painter)
     , mTile(nullptr)
+    , mMipmapLevel(0)
     , mIsOpenGL(hasOpenGLEngine(painter))
+    , mFlatColorTileSize(flatColorTileSize)
 {
+    // The transform of the painter already includes the scale at which the
+    // map is being rendered, which is not necessarily known by the renderer.
+    const QTransform transform = painter->transform();
+    mPainterScale = qSqrt(qAbs(transform.determinant()));
+
+    if (QPaintDevice *device = painter->device())
+        mPainterScale *= device->devicePixelRatio();
+}
+
+/**
+ * Returns the mipmap level to use for an image of \a imageSize pixels that
+ * is drawn at the given \a scale. This is the smallest level that is still
+ * at least as large as the image ends up on the screen.
+ */
+int CellRenderer::mipmapLevel(const QSize &imageSize, const QSizeF &scale) const
+{
+    qreal factor = mPainterScale * qMax(scale.width(), scale.height());
+    int minimumSize = qMin(imageSize.width(), imageSize.height());
+    int level = 0;
+
+    while (factor <= 0.5 && minimumSize > 1) {
+        factor *= 2;
+        minimumSize /= 2;
+        ++level;
+    }
+
+    return level;
 }
 
 /**
@@ -107,13 +169,24 @@ CellRenderer::CellRenderer(QPainter *painter)
  */
 void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &cellSize, Origin origin)
 {
-    if (mTile != cell.tile)
-        flush();
-
-    const QPixmap &image = cell.tile->currentFrameImage();
-    const QSizeF size = image.size();
+    const QPixmap &fullImage = cell.tile->currentFrameImage();
+    const QSizeF size = fullImage.size();
     const QSizeF objectSize = (cellSize == QSizeF(0,0)) ? size : cellSize;
     const QSizeF scale(objectSize.width() / size.width(), objectSize.height() / size.height());
+
+    // When a tile covers only a pixel or two, just draw its average color
+    const qreal screenSize = qMax(objectSize.width(), objectSize.height()) * mPainterScale;
+    const bool flat = screenSize < mFlatColorTileSize;
+
+    // When zoomed out, draw from a prefiltered smaller version of the image
+    const int level = flat ? 0 : mipmapLevel(fullImage.size(), scale);
+
+    if (flat || mTile != cell.tile || mMipmapLevel != level)
+        flush();
+
+    const QPixmap &image = flat ? fullImage : cell.tile->currentFrameMipmap(level);
+    const QSizeF imageScale(objectSize.width() / image.width(),
+                            objectSize.height() / image.height());
     const QPoint offset = cell.tile->offset();
     const QPointF sizeHalf = QPointF(objectSize.width() / 2, objectSize.height() / 2);
 
@@ -122,8 +195,8 @@ void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &ce
     fragment.y = pos.y() + (offset.y() * scale.height()) + sizeHalf.y() - objectSize.height();
     fragment.sourceLeft = 0;
     fragment.sourceTop = 0;
-    fragment.width = size.width();
-    fragment.height = size.height();
+    fragment.width = image.width();
+    fragment.height = image.height();
     fragment.scaleX = cell.flippedHorizontally ? -1 : 1;
     fragment.scaleY = cell.flippedVertically ? -1 : 1;
     fragment.rotation = 0;
@@ -148,11 +221,24 @@ void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &ce
             fragment.x += halfDiff;
     }
     
-    fragment.scaleX = scale.width() * (flippedHorizontally ? -1 : 1);
-    fragment.scaleY = scale.height() * (flippedVertically ? -1 : 1);
+    fragment.scaleX = imageScale.width() * (flippedHorizontally ? -1 : 1);
+    fragment.scaleY = imageScale.height() * (flippedVertically ? -1 : 1);
+
+    if (flat) {
+        QSizeF flatSize = objectSize;
+        if (cell.flippedAntiDiagonally)
+            flatSize.transpose();
+
+        renderFlat(cell, QPointF(fragment.x, fragment.y), flatSize);
+        return;
+    }
 
     if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
-        mTile = cell.tile;
+        if (mFragments.isEmpty()) {
+            mTile = cell.tile;
+            mMipmapLevel = level;
+            mImage = image;
+        }
         mFragments.append(fragment);
         return;
     }
@@ -177,6 +263,30 @@ void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &ce
     mPainter->setTransform(oldTransform);
 }
 
+/**
+ * Fills the area of \a size centered on \a center with the average color
+ * of the tile of the given \a cell.
+ */
+void CellRenderer::renderFlat(const Cell &cell, const QPointF &center, const QSizeF &size)
+{
+    const QRgb color = cell.tile->currentFrameTile()->averageColor();
+    const int alpha = qAlpha(color);
+    if (alpha == 0)
+        return;
+
+    // The average color is premultiplied, while QColor is not
+    const QColor fillColor(qRed(color) * 255 / alpha,
+                           qGreen(color) * 255 / alpha,
+                           qBlue(color) * 255 / alpha,
+                           alpha);
+
+    const QRectF rect(center.x() - size.width() / 2,
+                      center.y() - size.height() / 2,
+                      size.width(), size.height());
+
+    mPainter->fillRect(rect, fillColor);
+}
+
 /**
  * Renders any remaining cells.
  */
@@ -187,8 +297,9 @@ void CellRenderer::flush()
 
     mPainter->drawPixmapFragments(mFragments.constData(),
                                   mFragments.size(),
-                                  mTile->currentFrameImage());
+                                  mImage);
 
     mTile = nullptr;
+    mImage = QPixmap();
     mFragments.resize(0);
 }
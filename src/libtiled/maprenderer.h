@@ -62,6 +62,7 @@ public:
         , mFlags(nullptr)
         , mObjectLineWidth(2)
         , mPainterScale(1)
+        , mFlatColorTileSize(0)
     {}
 
     virtual ~MapRenderer() {}
@@ -209,17 +210,35 @@ public:
     qreal painterScale() const { return mPainterScale; }
     void setPainterScale(qreal painterScale) { mPainterScale = painterScale; }
 
+    /**
+     * The on-screen size in pixels below which tiles are drawn as rectangles
+     * filled with their average color, rather than drawing their image.
+     * Defaults to 0, which means tiles are always drawn using their image.
+     */
+    qreal flatColorTileSize() const { return mFlatColorTileSize; }
+    void setFlatColorTileSize(qreal size) { mFlatColorTileSize = size; }
+
     RenderFlags flags() const { return mFlags; }
     void setFlags(RenderFlags flags) { mFlags = flags; }
 
     static QPolygonF lineToPolygon(const QPointF &start, const QPointF &end);
 
+protected:
+    /**
+     * Returns the part of \a region that may be visible within the
+     * \a exposed rectangle, in screen coordinates. Returns \a region
+     * unchanged when \a exposed is null.
+     */
+    QRegion exposedTileRegion(const QRegion &region,
+                              const QRectF &exposed) const;
+
 private:
     const Map *mMap;
 
     RenderFlags mFlags;
     qreal mObjectLineWidth;
     qreal mPainterScale;
+    qreal mFlatColorTileSize;
 };
 
 inline const Map *MapRenderer::map() const
@@ -259,7 +278,7 @@ public:
         BottomCenter
     };
 
-    explicit CellRenderer(QPainter *painter);
+    explicit CellRenderer(QPainter *painter, qreal flatColorTileSize = 0);
 
     ~CellRenderer() { flush(); }
 
@@ -267,10 +286,17 @@ public:
     void flush();
 
 private:
+    void renderFlat(const Cell &cell, const QPointF &center, const QSizeF &size);
+    int mipmapLevel(const QSize &imageSize, const QSizeF &scale) const;
+
     QPainter * const mPainter;
     Tile *mTile;
+    int mMipmapLevel;
+    QPixmap mImage;
     QVector<QPainter::PixmapFragment> mFragments;
     const bool mIsOpenGL;
+    qreal mPainterScale;
+    const qreal mFlatColorTileSize;
 };
 
 } // namespace Tiled
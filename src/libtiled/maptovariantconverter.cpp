@@ -264,10 +264,11 @@ QVariant MapToVariantConverter::toVariant(const TileLayer *tileLayer,
     switch (format) {
     case Map::XML:
     case Map::CSV: {
+        const QVector<unsigned> gids = mGidMapper.layerGids(*tileLayer);
         QVariantList tileVariants;
-        for (int y = 0; y < tileLayer->height(); ++y)
-            for (int x = 0; x < tileLayer->width(); ++x)
-                tileVariants << mGidMapper.cellToGid(tileLayer->cellAt(x, y));
+        tileVariants.reserve(gids.size());
+        for (unsigned gid : gids)
+            tileVariants << gid;
 
         tileLayerVariant[QLatin1String("data")] = tileVariants;
         break;
@@ -35,6 +35,7 @@
 #include "map.h"
 #include "mapobject.h"
 #include "imagelayer.h"
+#include "layerexport.h"
 #include "objectgroup.h"
 #include "tile.h"
 #include "tilelayer.h"
@@ -428,30 +429,26 @@ void MapWriterPrivate::writeTileLayer(QXmlStreamWriter &w,
         w.writeAttribute(QLatin1String("compression"), compression);
 
     if (mLayerDataFormat == Map::XML) {
-        for (int y = 0; y < tileLayer.height(); ++y) {
-            for (int x = 0; x < tileLayer.width(); ++x) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
-                w.writeStartElement(QLatin1String("tile"));
-                w.writeAttribute(QLatin1String("gid"), QString::number(gid));
-                w.writeEndElement();
-            }
+        for (unsigned gid : mGidMapper.layerGids(tileLayer)) {
+            w.writeStartElement(QLatin1String("tile"));
+            w.writeAttribute(QLatin1String("gid"), QString::number(gid));
+            w.writeEndElement();
         }
     } else if (mLayerDataFormat == Map::CSV) {
-        QString tileData;
-
-        for (int y = 0; y < tileLayer.height(); ++y) {
-            for (int x = 0; x < tileLayer.width(); ++x) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
-                tileData.append(QString::number(gid));
-                if (x != tileLayer.width() - 1
-                    || y != tileLayer.height() - 1)
-                    tileData.append(QLatin1String(","));
-            }
-            tileData.append(QLatin1String("\n"));
+        const QVector<unsigned> gids = mGidMapper.layerGids(tileLayer);
+        const int width = tileLayer.width();
+        const int height = tileLayer.height();
+
+        RowFormatter formatter;
+        for (int y = 0; y < height; ++y) {
+            formatter.appendRow(gids.constData() + y * width, width);
+            if (y != height - 1)
+                formatter.append(',');
+            formatter.append('\n');
         }
 
         w.writeCharacters(QLatin1String("\n"));
-        w.writeCharacters(tileData);
+        w.writeCharacters(QString::fromLatin1(formatter.buffer()));
     } else {
         QByteArray tileData = mGidMapper.encodeLayerData(tileLayer,
                                                          mLayerDataFormat);
@@ -42,6 +42,7 @@ using namespace Tiled;
 ObjectGroup::ObjectGroup()
     : Layer(ObjectGroupType, QString(), 0, 0, 0, 0)
     , mDrawOrder(TopDownOrder)
+    , mObjectIndexesValid(true)
 {
 }
 
@@ -49,6 +50,7 @@ ObjectGroup::ObjectGroup(const QString &name,
                          int x, int y, int width, int height)
     : Layer(ObjectGroupType, name, x, y, width, height)
     , mDrawOrder(TopDownOrder)
+    , mObjectIndexesValid(true)
 {
 }
 
@@ -59,6 +61,9 @@ ObjectGroup::~ObjectGroup()
 
 void ObjectGroup::addObject(MapObject *object)
 {
+    if (mObjectIndexesValid)
+        mObjectIndexes.insert(object, mObjects.size());
+
     mObjects.append(object);
     object->setObjectGroup(this);
     if (mMap && object->id() == 0)
@@ -67,6 +72,11 @@ void ObjectGroup::addObject(MapObject *object)
 
 void ObjectGroup::insertObject(int index, MapObject *object)
 {
+    if (index == mObjects.size() && mObjectIndexesValid)
+        mObjectIndexes.insert(object, index);
+    else
+        invalidateObjectIndexes();
+
     mObjects.insert(index, object);
     object->setObjectGroup(this);
     if (mMap && object->id() == 0)
@@ -75,11 +85,10 @@ void ObjectGroup::insertObject(int index, MapObject *object)
 
 int ObjectGroup::removeObject(MapObject *object)
 {
-    const int index = mObjects.indexOf(object);
+    const int index = indexOf(object);
     Q_ASSERT(index != -1);
 
-    mObjects.removeAt(index);
-    object->setObjectGroup(nullptr);
+    removeObjectAt(index);
     return index;
 }
 
@@ -87,6 +96,12 @@ void ObjectGroup::removeObjectAt(int index)
 {
     MapObject *object = mObjects.takeAt(index);
     object->setObjectGroup(nullptr);
+
+    // Only the indexes of the objects after the removed one change
+    if (index == mObjects.size() && mObjectIndexesValid)
+        mObjectIndexes.remove(object);
+    else
+        invalidateObjectIndexes();
 }
 
 void ObjectGroup::moveObjects(int from, int to, int count)
@@ -109,6 +124,28 @@ void ObjectGroup::moveObjects(int from, int to, int count)
 
     for (int i = 0; i < count; ++i)
         mObjects.insert(to + i, movingObjects.at(i));
+
+    invalidateObjectIndexes();
+}
+
+/**
+ * Returns the index of the given \a object, or -1 when it is not part of this
+ * object group.
+ *
+ * The indexes are cached, which makes repeated lookups a lot faster than
+ * searching the list of objects.
+ */
+int ObjectGroup::indexOf(const MapObject *object) const
+{
+    if (!mObjectIndexesValid) {
+        mObjectIndexes.clear();
+        mObjectIndexes.reserve(mObjects.size());
+        for (int i = 0; i < mObjects.size(); ++i)
+            mObjectIndexes.insert(mObjects.at(i), i);
+        mObjectIndexesValid = true;
+    }
+
+    return mObjectIndexes.value(object, -1);
 }
 
 QRectF ObjectGroup::objectsBoundingRect() const
@@ -234,6 +271,12 @@ int ObjectGroup::highestObjectId() const
     return id;
 }
 
+void ObjectGroup::invalidateObjectIndexes()
+{
+    mObjectIndexes.clear();
+    mObjectIndexesValid = false;
+}
+
 ObjectGroup *ObjectGroup::initializeClone(ObjectGroup *clone) const
 {
     Layer::initializeClone(clone);
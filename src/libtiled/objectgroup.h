@@ -36,6 +36,7 @@
 #include "layer.h"
 
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QMetaType>
 
@@ -91,6 +92,8 @@ public:
      */
     MapObject *objectAt(int index) const { return mObjects.at(index); }
 
+    int indexOf(const MapObject *object) const;
+
     /**
      * Adds an object to this object group.
      */
@@ -192,9 +195,15 @@ protected:
     ObjectGroup *initializeClone(ObjectGroup *clone) const;
 
 private:
+    void invalidateObjectIndexes();
+
     QList<MapObject*> mObjects;
     QColor mColor;
     DrawOrder mDrawOrder;
+
+    // Maps objects to their index, built on demand
+    mutable QHash<const MapObject*, int> mObjectIndexes;
+    mutable bool mObjectIndexesValid;
 };
 
 
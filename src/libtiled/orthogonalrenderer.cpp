@@ -31,6 +31,7 @@
 #include "map.h"
 #include "mapobject.h"
 #include "tile.h"
+#include "tileblitter.h"
 #include "tilelayer.h"
 #include "tileset.h"
 
@@ -239,7 +240,12 @@ void OrthogonalRenderer::drawTileLayer(QPainter *painter,
     const QTransform savedTransform = painter->transform();
     painter->translate(layerPos);
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, flatColorTileSize());
+
+    // When drawing unscaled into an image, the tiles can be composited
+    // straight into its scanlines, which is a lot faster than going through
+    // the paint engine for each tile
+    TileBlitter blitter(painter);
 
     Map::RenderOrder renderOrder = map()->renderOrder();
 
@@ -273,6 +279,11 @@ void OrthogonalRenderer::drawTileLayer(QPainter *painter,
             if (cell.isEmpty())
                 continue;
 
+            if (blitter.isActive()) {
+                blitter.render(cell, QPoint(x * tileWidth, (y + 1) * tileHeight));
+                continue;
+            }
+
             renderer.render(cell,
                             QPointF(x * tileWidth, (y + 1) * tileHeight),
                             QSizeF(0, 0),
@@ -290,8 +301,10 @@ void OrthogonalRenderer::drawTileSelection(QPainter *painter,
                                            const QColor &color,
                                            const QRectF &exposed) const
 {
-    foreach (const QRect &r, region.rects()) {
-        const QRectF toFill = QRectF(boundingRect(r)).intersected(exposed);
+    foreach (const QRect &r, exposedTileRegion(region, exposed).rects()) {
+        QRectF toFill = boundingRect(r);
+        if (!exposed.isNull())
+            toFill &= exposed;
         if (!toFill.isEmpty())
             painter->fillRect(toFill, color);
     }
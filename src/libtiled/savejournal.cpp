@@ -0,0 +1,385 @@
+/*
+ * savejournal.cpp
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "savejournal.h"
+
+#include "gidmapper.h"
+#include "map.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+using namespace Tiled;
+
+static const quint32 JournalMagic = 0x4C4E4A54; // "TJNL"
+static const quint32 JournalVersion = 2;
+
+static void setupStream(QDataStream &stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setVersion(QDataStream::Qt_5_0);
+}
+
+/**
+ * Identifies the version of the map file a journal applies to.
+ */
+struct BaseFile
+{
+    explicit BaseFile(const QString &mapFileName)
+    {
+        const QFileInfo info(mapFileName);
+        lastModified = info.lastModified().toMSecsSinceEpoch();
+        size = info.size();
+    }
+
+    BaseFile()
+        : lastModified(0)
+        , size(0)
+    {}
+
+    bool operator==(const BaseFile &other) const
+    {
+        return lastModified == other.lastModified && size == other.size;
+    }
+
+    qint64 lastModified;
+    qint64 size;
+};
+
+/**
+ * Returns the first global tile ID of each tileset of the given \a map, as
+ * assigned by GidMapper.
+ */
+static QVector<quint32> firstGids(const Map *map)
+{
+    QVector<quint32> gids;
+    quint32 firstGid = 1;
+    for (const SharedTileset &tileset : map->tilesets()) {
+        gids.append(firstGid);
+        firstGid += tileset->nextTileId();
+    }
+    return gids;
+}
+
+/**
+ * The header of a journal identifies the map file it applies to and stores
+ * the first global tile IDs that were used for the tiles in its records.
+ * These change when a tileset grows, so they can't be derived from the map.
+ */
+static void writeHeader(QDataStream &out,
+                        const BaseFile &base,
+                        const QVector<quint32> &firstGids)
+{
+    out << JournalMagic << JournalVersion
+        << base.lastModified << base.size
+        << quint32(firstGids.size());
+
+    for (quint32 firstGid : firstGids)
+        out << firstGid;
+}
+
+static bool readHeader(QDataStream &in,
+                       BaseFile &base,
+                       QVector<quint32> &firstGids)
+{
+    quint32 magic, version, tilesetCount;
+    in >> magic >> version >> base.lastModified >> base.size >> tilesetCount;
+
+    if (in.status() != QDataStream::Ok ||
+            magic != JournalMagic ||
+            version != JournalVersion)
+        return false;
+
+    // Not reserving space up front, since the count may be corrupt
+    for (quint32 i = 0; i < tilesetCount; ++i) {
+        quint32 firstGid;
+        in >> firstGid;
+        if (in.status() != QDataStream::Ok)
+            return false;
+        firstGids.append(firstGid);
+    }
+
+    return true;
+}
+
+/**
+ * Skips over the complete records following the current position of the
+ * \a stream. Returns the position right after the last complete record.
+ */
+static qint64 skipCompleteRecords(QDataStream &stream)
+{
+    QIODevice *device = stream.device();
+    qint64 end = device->pos();
+
+    forever {
+        quint32 recordSize;
+        stream >> recordSize;
+        if (stream.status() != QDataStream::Ok)
+            break;
+
+        const qint64 next = device->pos() + recordSize;
+        if (next > device->size())
+            break;
+
+        device->seek(next);
+        end = next;
+    }
+
+    stream.resetStatus();
+    return end;
+}
+
+QString SaveJournal::fileName(const QString &mapFileName)
+{
+    return mapFileName + QLatin1String(".journal");
+}
+
+qint64 SaveJournal::size(const QString &mapFileName)
+{
+    const QFileInfo info(fileName(mapFileName));
+    return info.exists() ? info.size() : 0;
+}
+
+bool SaveJournal::append(const QString &mapFileName,
+                         const Map *map,
+                         const QHash<Layer*, QRegion> &regions,
+                         QString *error)
+{
+    QFile file(fileName(mapFileName));
+    const bool existing = file.exists();
+
+    if (!file.open(QIODevice::ReadWrite)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    setupStream(stream);
+
+    const BaseFile currentBase(mapFileName);
+    const QVector<quint32> currentFirstGids = firstGids(map);
+
+    if (existing) {
+        BaseFile base;
+        QVector<quint32> journalFirstGids;
+        if (!readHeader(stream, base, journalFirstGids) || !(base == currentBase)) {
+            if (error)
+                *error = tr("The save journal does not match the map file.");
+            return false;
+        }
+
+        // The tiles in the existing records were stored with these IDs
+        if (journalFirstGids != currentFirstGids) {
+            if (error)
+                *error = tr("The save journal does not match the tilesets of the map.");
+            return false;
+        }
+
+        // A save that was interrupted may have left an incomplete record,
+        // which would make the records after it unreadable
+        const qint64 end = skipCompleteRecords(stream);
+        if (end != file.size()) {
+            qWarning() << "Removing incomplete record from" << file.fileName();
+            file.resize(end);
+        }
+        file.seek(end);
+    } else {
+        writeHeader(stream, currentBase, currentFirstGids);
+    }
+
+    // The record is prefixed with its size, so that a record that was only
+    // partially written can be detected when replaying.
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    setupStream(out);
+
+    const GidMapper gidMapper(map->tilesets());
+
+    QVector<const TileLayer*> layers;
+    for (auto it = regions.constBegin(); it != regions.constEnd(); ++it)
+        if (map->layers().contains(it.key()) && it.key()->isTileLayer())
+            layers.append(static_cast<const TileLayer*>(it.key()));
+
+    out << quint32(layers.size());
+
+    for (const TileLayer *tileLayer : layers) {
+        Layer *layer = const_cast<TileLayer*>(tileLayer);
+        const QRegion region = regions.value(layer)
+                .translated(-tileLayer->position())
+                .intersected(QRect(0, 0, tileLayer->width(), tileLayer->height()));
+        const QVector<QRect> rects = region.rects();
+
+        out << quint32(map->layers().indexOf(layer))
+            << quint32(rects.size());
+
+        for (const QRect &rect : rects) {
+            out << qint32(rect.x()) << qint32(rect.y())
+                << qint32(rect.width()) << qint32(rect.height());
+
+            for (int y = rect.top(); y <= rect.bottom(); ++y)
+                for (int x = rect.left(); x <= rect.right(); ++x)
+                    out << quint32(gidMapper.cellToGid(tileLayer->cellAt(x, y)));
+        }
+    }
+
+    stream << quint32(record.size());
+    stream.writeRawData(record.constData(), record.size());
+
+    if (file.error() != QFile::NoError) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool SaveJournal::replay(const QString &mapFileName,
+                         Map *map,
+                         QString *error)
+{
+    QFile file(fileName(mapFileName));
+    if (!file.exists())
+        return true;
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    setupStream(stream);
+
+    BaseFile base;
+    QVector<quint32> journalFirstGids;
+    if (!readHeader(stream, base, journalFirstGids)) {
+        if (error)
+            *error = tr("Invalid save journal: %1").arg(file.fileName());
+        return false;
+    }
+
+    if (!(base == BaseFile(mapFileName))) {
+        qWarning() << "Ignoring outdated save journal" << file.fileName();
+        return true;
+    }
+
+    if (journalFirstGids.size() != map->tilesetCount()) {
+        qWarning() << "Ignoring save journal with different tilesets" << file.fileName();
+        return true;
+    }
+
+    // Decode the tiles using the IDs they were stored with, which differ
+    // from the current ones when a tileset grew in the meantime
+    GidMapper gidMapper;
+    for (int i = 0; i < journalFirstGids.size(); ++i)
+        gidMapper.insert(journalFirstGids.at(i), map->tilesetAt(i).data());
+    const QString corruptError = tr("Corrupt save journal: %1").arg(file.fileName());
+
+    while (!stream.atEnd()) {
+        quint32 recordSize;
+        stream >> recordSize;
+
+        if (stream.status() != QDataStream::Ok ||
+                recordSize > quint64(file.size() - file.pos())) {
+            qWarning() << "Skipping incomplete record in" << file.fileName();
+            break;
+        }
+
+        QByteArray record(int(recordSize), Qt::Uninitialized);
+        if (stream.readRawData(record.data(), record.size()) != record.size()) {
+            // The last save was interrupted, skip its incomplete record
+            qWarning() << "Skipping incomplete record in" << file.fileName();
+            break;
+        }
+
+        QDataStream in(record);
+        setupStream(in);
+
+        quint32 layerCount;
+        in >> layerCount;
+
+        for (quint32 i = 0; i < layerCount; ++i) {
+            quint32 layerIndex, rectCount;
+            in >> layerIndex >> rectCount;
+
+            if (in.status() != QDataStream::Ok ||
+                    layerIndex >= quint32(map->layerCount()) ||
+                    !map->layerAt(layerIndex)->isTileLayer()) {
+                if (error)
+                    *error = corruptError;
+                return false;
+            }
+
+            TileLayer *tileLayer = map->layerAt(layerIndex)->asTileLayer();
+
+            for (quint32 r = 0; r < rectCount; ++r) {
+                qint32 x, y, width, height;
+                in >> x >> y >> width >> height;
+
+                const QRect rect(x, y, width, height);
+                if (in.status() != QDataStream::Ok ||
+                        !QRect(0, 0, tileLayer->width(), tileLayer->height()).contains(rect)) {
+                    if (error)
+                        *error = corruptError;
+                    return false;
+                }
+
+                for (int ty = rect.top(); ty <= rect.bottom(); ++ty) {
+                    for (int tx = rect.left(); tx <= rect.right(); ++tx) {
+                        quint32 gid;
+                        in >> gid;
+
+                        bool ok;
+                        const Cell cell = gidMapper.gidToCell(gid, ok);
+                        if (!ok || in.status() != QDataStream::Ok) {
+                            if (error)
+                                *error = corruptError;
+                            return false;
+                        }
+
+                        tileLayer->setCell(tx, ty, cell);
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void SaveJournal::discard(const QString &mapFileName)
+{
+    QFile::remove(fileName(mapFileName));
+}
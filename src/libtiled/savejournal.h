@@ -0,0 +1,103 @@
+/*
+ * savejournal.h
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TILED_SAVEJOURNAL_H
+#define TILED_SAVEJOURNAL_H
+
+#include "tiled_global.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QRegion>
+#include <QString>
+
+namespace Tiled {
+
+class Layer;
+class Map;
+
+/**
+ * The save journal allows saving changes to the tiles of a map without
+ * writing out the whole map. The changed regions are appended to a journal
+ * file next to the map, which is replayed on top of the map when it is
+ * loaded.
+ *
+ * The journal remembers the modification time and size of the map file it
+ * was started for, so that it is not applied to a map that was written by
+ * something else in the meantime. It also stores the first global tile ID
+ * of each tileset, so that its tiles are decoded with the IDs they were
+ * written with.
+ */
+class TILEDSHARED_EXPORT SaveJournal
+{
+    Q_DECLARE_TR_FUNCTIONS(SaveJournal)
+
+public:
+    /**
+     * Returns the file name of the journal belonging to \a mapFileName.
+     */
+    static QString fileName(const QString &mapFileName);
+
+    /**
+     * Returns the size of the journal belonging to \a mapFileName, or 0 when
+     * there is no journal.
+     */
+    static qint64 size(const QString &mapFileName);
+
+    /**
+     * Appends the current contents of the given \a regions of the tile
+     * layers of \a map to the journal. The regions are in tile coordinates.
+     *
+     * Returns whether the changes were written successfully.
+     */
+    static bool append(const QString &mapFileName,
+                       const Map *map,
+                       const QHash<Layer*, QRegion> &regions,
+                       QString *error = nullptr);
+
+    /**
+     * Applies the journal belonging to \a mapFileName to \a map, when there
+     * is one. A journal that was started for a different version of the map
+     * file is ignored.
+     *
+     * Returns false when the journal could not be applied.
+     */
+    static bool replay(const QString &mapFileName,
+                       Map *map,
+                       QString *error = nullptr);
+
+    /**
+     * Removes the journal belonging to \a mapFileName. Should be called
+     * after the whole map was written.
+     */
+    static void discard(const QString &mapFileName);
+};
+
+} // namespace Tiled
+
+#endif // TILED_SAVEJOURNAL_H
@@ -31,12 +31,16 @@
 #include "objectgroup.h"
 #include "tileset.h"
 
+#include <QImage>
+
 using namespace Tiled;
 
 Tile::Tile(int id, Tileset *tileset):
     Object(TileType),
     mId(id),
     mTileset(tileset),
+    mAverageColor(0),
+    mAverageColorValid(false),
     mTerrain(-1),
     mProbability(1.f),
     mObjectGroup(nullptr),
@@ -49,6 +53,8 @@ Tile::Tile(const QPixmap &image, int id, Tileset *tileset):
     mId(id),
     mTileset(tileset),
     mImage(image),
+    mAverageColor(0),
+    mAverageColorValid(false),
     mTerrain(-1),
     mProbability(1.f),
     mObjectGroup(nullptr),
@@ -70,17 +76,108 @@ QSharedPointer<Tileset> Tile::sharedTileset() const
 }
 
 /**
- * Returns the image for rendering this tile, taking into account tile
- * animations.
+ * Returns the tile whose image should be used for rendering this tile,
+ * taking into account tile animations.
  */
-const QPixmap &Tile::currentFrameImage() const
+const Tile *Tile::currentFrameTile() const
 {
     if (isAnimated()) {
         const Frame &frame = mFrames.at(mCurrentFrameIndex);
-        return mTileset->findTile(frame.tileId)->image();
+        return mTileset->findTile(frame.tileId);
     } else {
+        return this;
+    }
+}
+
+/**
+ * Returns the image for rendering this tile, taking into account tile
+ * animations.
+ */
+const QPixmap &Tile::currentFrameImage() const
+{
+    return currentFrameTile()->image();
+}
+
+/**
+ * Returns the image of this tile scaled down by a factor of two \a level
+ * times, where level 0 is the image itself.
+ *
+ * The levels are created lazily by smoothly scaling down the previous level
+ * and are kept until the image of the tile changes. This allows zoomed out
+ * rendering to use a prefiltered image instead of filtering down the full
+ * image for each cell.
+ */
+const QPixmap &Tile::mipmap(int level) const
+{
+    if (level <= 0 || mImage.isNull())
         return mImage;
+
+    if (mMipmaps.size() < level) {
+        QImage image = (mMipmaps.isEmpty() ? mImage : mMipmaps.last()).toImage();
+
+        while (mMipmaps.size() < level) {
+            const QSize size(qMax(1, image.width() / 2),
+                             qMax(1, image.height() / 2));
+            image = image.scaled(size, Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation);
+            mMipmaps.append(QPixmap::fromImage(image));
+        }
     }
+
+    return mMipmaps.at(level - 1);
+}
+
+/**
+ * Returns the given mipmap \a level of the image for rendering this tile,
+ * taking into account tile animations.
+ *
+ * \sa mipmap()
+ */
+const QPixmap &Tile::currentFrameMipmap(int level) const
+{
+    return currentFrameTile()->mipmap(level);
+}
+
+/**
+ * Returns the average color of the image of this tile, as a premultiplied
+ * color. It is calculated when first needed and cached until the image
+ * changes.
+ *
+ * This color is used to represent the tile when it covers only a pixel or
+ * two on the screen.
+ */
+QRgb Tile::averageColor() const
+{
+    if (mAverageColorValid)
+        return mAverageColor;
+
+    const QImage image = mImage.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int pixelCount = image.width() * image.height();
+
+    quint64 red = 0, green = 0, blue = 0, alpha = 0;
+
+    for (int y = 0; y < image.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const QRgb pixel = line[x];
+            red += qRed(pixel);
+            green += qGreen(pixel);
+            blue += qBlue(pixel);
+            alpha += qAlpha(pixel);
+        }
+    }
+
+    if (pixelCount > 0) {
+        mAverageColor = qRgba(int(red / pixelCount),
+                              int(green / pixelCount),
+                              int(blue / pixelCount),
+                              int(alpha / pixelCount));
+    } else {
+        mAverageColor = 0;
+    }
+
+    mAverageColorValid = true;
+    return mAverageColor;
 }
 
 /**
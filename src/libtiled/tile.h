@@ -105,8 +105,14 @@ public:
     const QPixmap &image() const;
     void setImage(const QPixmap &image);
 
+    const Tile *currentFrameTile() const;
     const QPixmap &currentFrameImage() const;
 
+    const QPixmap &mipmap(int level) const;
+    const QPixmap &currentFrameMipmap(int level) const;
+
+    QRgb averageColor() const;
+
     const QString &imageSource() const;
     void setImageSource(const QString &imageSource);
 
@@ -144,6 +150,9 @@ private:
     int mId;
     Tileset *mTileset;
     QPixmap mImage;
+    mutable QVector<QPixmap> mMipmaps;
+    mutable QRgb mAverageColor;
+    mutable bool mAverageColorValid;
     QString mImageSource;
     unsigned mTerrain;
     float mProbability;
@@ -186,6 +195,8 @@ inline const QPixmap &Tile::image() const
 inline void Tile::setImage(const QPixmap &image)
 {
     mImage = image;
+    mMipmaps.clear();
+    mAverageColorValid = false;
 }
 
 /**
@@ -0,0 +1,296 @@
+/*
+ * tileblitter.cpp
+ * Copyright 2016, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tileblitter.h"
+
+#include "tile.h"
+#include "tilelayer.h"
+
+#include <QPaintEngine>
+#include <QPainter>
+#include <QVarLengthArray>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TILED_BLIT_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Tiled;
+
+/**
+ * Multiplies all four channels of \a pixel with \a alpha / 255, two
+ * channels at a time. Rounds the same way as the raster paint engine.
+ */
+static inline uint byteMul(uint pixel, uint alpha)
+{
+    uint rb = (pixel & 0xff00ff) * alpha;
+    rb = (rb + ((rb >> 8) & 0xff00ff) + 0x800080) >> 8;
+    rb &= 0xff00ff;
+
+    uint ag = ((pixel >> 8) & 0xff00ff) * alpha;
+    ag = ag + ((ag >> 8) & 0xff00ff) + 0x800080;
+    ag &= 0xff00ff00;
+
+    return ag | rb;
+}
+
+#ifdef TILED_BLIT_SSE2
+/**
+ * Like byteMul, for four pixels at once. The \a alpha is expected in each
+ * 16-bit half of the 32-bit lanes.
+ */
+static inline __m128i byteMulSse2(__m128i pixels, __m128i alpha)
+{
+    const __m128i colorMask = _mm_set1_epi32(0x00ff00ff);
+    const __m128i half = _mm_set1_epi16(0x80);
+
+    __m128i ag = _mm_srli_epi16(pixels, 8);
+    __m128i rb = _mm_and_si128(pixels, colorMask);
+    ag = _mm_mullo_epi16(ag, alpha);
+    rb = _mm_mullo_epi16(rb, alpha);
+    ag = _mm_add_epi16(ag, _mm_srli_epi16(ag, 8));
+    rb = _mm_add_epi16(rb, _mm_srli_epi16(rb, 8));
+    ag = _mm_add_epi16(ag, half);
+    rb = _mm_add_epi16(rb, half);
+    ag = _mm_andnot_si128(colorMask, ag);
+    rb = _mm_srli_epi16(rb, 8);
+
+    return _mm_or_si128(ag, rb);
+}
+#endif
+
+/**
+ * Sets up the blitter for the given \a painter. It will only be active when
+ * the painter is drawing on a 32-bit image with a transform that is just a
+ * translation by whole pixels, without clipping and using the default
+ * composition mode.
+ */
+TileBlitter::TileBlitter(QPainter *painter)
+    : mImage(nullptr)
+    , mOpacity(255)
+    , mLastTile(nullptr)
+    , mLastTileImage(nullptr)
+{
+    QPaintDevice *device = painter->device();
+    if (!device || device->devType() != QInternal::Image)
+        return;
+    if (painter->paintEngine()->type() != QPaintEngine::Raster)
+        return;
+
+    QImage *image = static_cast<QImage*>(device);
+    if (image->format() != QImage::Format_ARGB32_Premultiplied &&
+            image->format() != QImage::Format_RGB32)
+        return;
+
+    // Writing to a shared image would detach it from under the paint engine
+    if (!image->isDetached() || image->devicePixelRatio() != 1)
+        return;
+
+    if (painter->hasClipping() ||
+            painter->compositionMode() != QPainter::CompositionMode_SourceOver)
+        return;
+
+    const QTransform transform = painter->deviceTransform();
+    if (transform.type() > QTransform::TxTranslate)
+        return;
+
+    const QPoint origin(qRound(transform.dx()), qRound(transform.dy()));
+    if (origin.x() != transform.dx() || origin.y() != transform.dy())
+        return;
+
+    mImage = image;
+    mOrigin = origin;
+    mOpacity = qRound(qBound(qreal(0), painter->opacity(), qreal(1)) * 255);
+}
+
+/**
+ * Draws the given \a cell with its bottom-left corner at \a pos, taking
+ * into account the flipping and tile offset. Matches what CellRenderer does
+ * for the BottomLeft origin when the cell is drawn at its image size.
+ */
+void TileBlitter::render(const Cell &cell, const QPoint &pos)
+{
+    if (mOpacity == 0)
+        return;
+
+    const TileImage &tile = tileImage(cell.tile->currentFrameTile());
+    const QImage &source = tile.image;
+    const int width = source.width();
+    const int height = source.height();
+
+    // Flipping anti-diagonally transposes the image
+    const bool transposed = cell.flippedAntiDiagonally;
+    const int targetWidth = transposed ? height : width;
+    const int targetHeight = transposed ? width : height;
+
+    const QPoint offset = cell.tile->offset();
+    const int left = mOrigin.x() + pos.x() + offset.x();
+    const int top = mOrigin.y() + pos.y() + offset.y() - targetHeight;
+
+    // Only the part within the image is drawn
+    const int startX = qMax(0, -left);
+    const int startY = qMax(0, -top);
+    const int endX = qMin(targetWidth, mImage->width() - left);
+    const int endY = qMin(targetHeight, mImage->height() - top);
+    if (startX >= endX || startY >= endY)
+        return;
+
+    const int count = endX - startX;
+    const int sourceStride = source.bytesPerLine() / sizeof(QRgb);
+    const QRgb *sourceBits = reinterpret_cast<const QRgb*>(source.constBits());
+    QVarLengthArray<QRgb, 256> row(count);
+
+    for (int y = startY; y < endY; ++y) {
+        QRgb *target = reinterpret_cast<QRgb*>(mImage->scanLine(top + y)) + left + startX;
+
+        if (!transposed) {
+            const int sourceY = cell.flippedVertically ? height - 1 - y : y;
+            const QRgb *sourceLine = sourceBits + sourceY * sourceStride;
+
+            if (!cell.flippedHorizontally) {
+                blendRow(target, sourceLine + startX, count, tile.opaque);
+                continue;
+            }
+
+            for (int x = 0; x < count; ++x)
+                row[x] = sourceLine[width - 1 - (startX + x)];
+        } else {
+            // Rows of the target are columns of the source
+            const int sourceX = cell.flippedVertically ? width - 1 - y : y;
+            const QRgb *sourceColumn = sourceBits + sourceX;
+
+            for (int x = 0; x < count; ++x) {
+                const int sourceY = cell.flippedHorizontally ? height - 1 - (startX + x)
+                                                             : startX + x;
+                row[x] = sourceColumn[sourceY * sourceStride];
+            }
+        }
+
+        blendRow(target, row.constData(), count, tile.opaque);
+    }
+}
+
+/**
+ * Returns the image of the given \a tile in the premultiplied format used
+ * for blending. The converted images are kept for as long as the blitter
+ * lives, which is typically a single drawTileLayer call.
+ */
+const TileBlitter::TileImage &TileBlitter::tileImage(const Tile *tile)
+{
+    if (tile == mLastTile)
+        return *mLastTileImage;
+
+    auto it = mTileImages.find(tile);
+    if (it == mTileImages.end()) {
+        TileImage tileImage;
+        const QPixmap &pixmap = tile->image();
+        tileImage.image = pixmap.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        tileImage.opaque = !pixmap.hasAlphaChannel();
+
+        if (!tileImage.opaque) {
+            const QImage &image = tileImage.image;
+            tileImage.opaque = true;
+            for (int y = 0; y < image.height() && tileImage.opaque; ++y) {
+                const QRgb *line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+                for (int x = 0; x < image.width(); ++x) {
+                    if (qAlpha(line[x]) != 255) {
+                        tileImage.opaque = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        it = mTileImages.insert(tile, tileImage);
+    }
+
+    mLastTile = tile;
+    mLastTileImage = &it.value();
+    return *mLastTileImage;
+}
+
+/**
+ * Composites \a count premultiplied pixels from \a source over those at
+ * \a destination. When the source is known to be \a opaque, the pixels are
+ * just copied.
+ */
+void TileBlitter::blendRow(QRgb *destination, const QRgb *source, int count,
+                           bool opaque) const
+{
+    if (mOpacity != 255) {
+        for (int i = 0; i < count; ++i) {
+            const QRgb pixel = byteMul(source[i], mOpacity);
+            destination[i] = pixel + byteMul(destination[i], 255 - qAlpha(pixel));
+        }
+        return;
+    }
+
+    if (opaque) {
+        std::memcpy(destination, source, count * sizeof(QRgb));
+        return;
+    }
+
+    int i = 0;
+
+#ifdef TILED_BLIT_SSE2
+    const __m128i alphaMask = _mm_set1_epi32(0xff000000);
+    const __m128i maxAlpha = _mm_set1_epi16(0xff);
+
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const __m128i alpha = _mm_and_si128(pixels, alphaMask);
+
+        // Skip the blending when all four pixels are opaque or transparent
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xffff) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), pixels);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, _mm_setzero_si128())) == 0xffff)
+            continue;
+
+        __m128i inverseAlpha = _mm_srli_epi32(pixels, 24);
+        inverseAlpha = _mm_or_si128(inverseAlpha, _mm_slli_epi32(inverseAlpha, 16));
+        inverseAlpha = _mm_sub_epi16(maxAlpha, inverseAlpha);
+
+        __m128i *target = reinterpret_cast<__m128i*>(destination + i);
+        const __m128i background = byteMulSse2(_mm_loadu_si128(target), inverseAlpha);
+        _mm_storeu_si128(target, _mm_add_epi8(pixels, background));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const QRgb pixel = source[i];
+        const int alpha = qAlpha(pixel);
+        if (alpha == 255)
+            destination[i] = pixel;
+        else if (alpha != 0)
+            destination[i] = pixel + byteMul(destination[i], 255 - alpha);
+    }
+}
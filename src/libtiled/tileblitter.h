@@ -0,0 +1,87 @@
+/*
+ * tileblitter.h
+ * Copyright 2016, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TILED_TILEBLITTER_H
+#define TILED_TILEBLITTER_H
+
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+
+class QPainter;
+
+namespace Tiled {
+
+class Cell;
+class Tile;
+
+/**
+ * Draws cells by compositing the tile images directly into the scanlines
+ * of the QImage a painter is drawing on, bypassing the paint engine.
+ *
+ * This is only possible in the simple but common case where the tiles end
+ * up at their original size on whole pixels, like when rendering a map at
+ * 100% into an image. Use isActive() to check whether the blitter can be
+ * used for the painter it was constructed with.
+ *
+ * The blitter assumes the painter is not used for anything else while it
+ * is drawing.
+ */
+class TileBlitter
+{
+public:
+    explicit TileBlitter(QPainter *painter);
+
+    bool isActive() const { return mImage != nullptr; }
+
+    void render(const Cell &cell, const QPoint &pos);
+
+private:
+    struct TileImage
+    {
+        QImage image;
+        bool opaque;
+    };
+
+    const TileImage &tileImage(const Tile *tile);
+
+    void blendRow(QRgb *destination, const QRgb *source, int count,
+                  bool opaque) const;
+
+    QImage *mImage;
+    QPoint mOrigin;
+    int mOpacity;
+
+    const Tile *mLastTile;
+    const TileImage *mLastTileImage;
+    QHash<const Tile*, TileImage> mTileImages;
+};
+
+} // namespace Tiled
+
+#endif // TILED_TILEBLITTER_H
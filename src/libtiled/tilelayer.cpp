@@ -34,9 +34,24 @@
 
 using namespace Tiled;
 
+/**
+ * Constructs a grid of the given size. All chunks initially share the same
+ * empty cells, so only chunks that get changed take up memory.
+ */
+CellGrid::CellGrid(int width, int height)
+    : mWidth(width)
+    , mHeight(height)
+{
+    static const QVector<Cell> emptyChunk(ChunkSize * ChunkSize);
+
+    const int columns = (width + ChunkMask) >> ChunkBits;
+    const int rows = (height + ChunkMask) >> ChunkBits;
+    mChunks.fill(emptyChunk, columns * rows);
+}
+
 TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
     : Layer(TileLayerType, name, x, y, width, height)
-    , mGrid(width * height)
+    , mGrid(width, height)
     , mUsedTilesetsDirty(false)
 {
     Q_ASSERT(width >= 0);
@@ -112,7 +127,9 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
 {
     Q_ASSERT(contains(x, y));
 
-    Cell &existingCell = mGrid[x + y * mWidth];
+    const Cell &existingCell = mGrid.at(x, y);
+    if (existingCell == cell)
+        return;
 
     if (!mUsedTilesetsDirty) {
         Tileset *oldTileset = existingCell.isEmpty() ? nullptr : existingCell.tile->tileset();
@@ -125,7 +142,7 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
         }
     }
 
-    existingCell = cell;
+    mGrid(x, y) = cell;
 }
 
 TileLayer *TileLayer::copy(const QRegion &region) const
@@ -193,19 +210,25 @@ void TileLayer::erase(const QRegion &area)
 
 void TileLayer::flip(FlipDirection direction)
 {
-    QVector<Cell> newGrid(mWidth * mHeight);
+    CellGrid newGrid(mWidth, mHeight);
 
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
 
+    // Empty cells are skipped, so that their chunks remain shared
     for (int y = 0; y < mHeight; ++y) {
         for (int x = 0; x < mWidth; ++x) {
-            Cell &dest = newGrid[x + y * mWidth];
             if (direction == FlipHorizontally) {
                 const Cell &source = cellAt(mWidth - x - 1, y);
+                if (source.isEmpty())
+                    continue;
+                Cell &dest = newGrid(x, y);
                 dest = source;
                 dest.flippedHorizontally = !source.flippedHorizontally;
             } else if (direction == FlipVertically) {
                 const Cell &source = cellAt(x, mHeight - y - 1);
+                if (source.isEmpty())
+                    continue;
+                Cell &dest = newGrid(x, y);
                 dest = source;
                 dest.flippedVertically = !source.flippedVertically;
             }
@@ -225,11 +248,14 @@ void TileLayer::rotate(RotateDirection direction)
 
     int newWidth = mHeight;
     int newHeight = mWidth;
-    QVector<Cell> newGrid(newWidth * newHeight);
+    CellGrid newGrid(newWidth, newHeight);
 
     for (int y = 0; y < mHeight; ++y) {
         for (int x = 0; x < mWidth; ++x) {
             const Cell &source = cellAt(x, y);
+            if (source.isEmpty())
+                continue;
+
             Cell dest = source;
 
             unsigned char mask =
@@ -244,9 +270,9 @@ void TileLayer::rotate(RotateDirection direction)
             dest.flippedAntiDiagonally = (mask & 1) != 0;
 
             if (direction == RotateRight)
-                newGrid[x * newWidth + (mHeight - y - 1)] = dest;
+                newGrid(mHeight - y - 1, x) = dest;
             else
-                newGrid[(mWidth - x - 1) * newWidth + y] = dest;
+                newGrid(y, mWidth - x - 1) = dest;
         }
     }
 
@@ -293,10 +319,12 @@ bool TileLayer::referencesTileset(const Tileset *tileset) const
 
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
-    for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
-        const Tile *tile = mGrid.at(i).tile;
-        if (tile && tile->tileset() == tileset)
-            mGrid.replace(i, Cell());
+    for (int y = 0; y < mHeight; ++y) {
+        for (int x = 0; x < mWidth; ++x) {
+            const Tile *tile = mGrid.at(x, y).tile;
+            if (tile && tile->tileset() == tileset)
+                mGrid(x, y) = Cell();
+        }
     }
 
     mUsedTilesets.remove(tileset->sharedPointer());
@@ -305,10 +333,12 @@ void TileLayer::removeReferencesToTileset(Tileset *tileset)
 void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
                                            Tileset *newTileset)
 {
-    for (Cell &cell : mGrid) {
-        const Tile *tile = cell.tile;
-        if (tile && tile->tileset() == oldTileset)
-            cell.tile = newTileset->findOrCreateTile(tile->id());
+    for (int y = 0; y < mHeight; ++y) {
+        for (int x = 0; x < mWidth; ++x) {
+            const Tile *tile = mGrid.at(x, y).tile;
+            if (tile && tile->tileset() == oldTileset)
+                mGrid(x, y).tile = newTileset->findOrCreateTile(tile->id());
+        }
     }
 
     if (mUsedTilesets.remove(oldTileset->sharedPointer()))
@@ -320,7 +350,7 @@ void TileLayer::resize(const QSize &size, const QPoint &offset)
     if (this->size() == size && offset.isNull())
         return;
 
-    QVector<Cell> newGrid(size.width() * size.height());
+    CellGrid newGrid(size.width(), size.height());
 
     // Copy over the preserved part
     const int startX = qMax(0, -offset.x());
@@ -330,8 +360,9 @@ void TileLayer::resize(const QSize &size, const QPoint &offset)
 
     for (int y = startY; y < endY; ++y) {
         for (int x = startX; x < endX; ++x) {
-            const int index = x + offset.x() + (y + offset.y()) * size.width();
-            newGrid[index] = cellAt(x, y);
+            const Cell &cell = cellAt(x, y);
+            if (!cell.isEmpty())
+                newGrid(x + offset.x(), y + offset.y()) = cell;
         }
     }
 
@@ -343,13 +374,14 @@ void TileLayer::offsetTiles(const QPoint &offset,
                             const QRect &bounds,
                             bool wrapX, bool wrapY)
 {
-    QVector<Cell> newGrid(mWidth * mHeight);
+    CellGrid newGrid(mWidth, mHeight);
 
     for (int y = 0; y < mHeight; ++y) {
         for (int x = 0; x < mWidth; ++x) {
             // Skip out of bounds tiles
             if (!bounds.contains(x, y)) {
-                newGrid[x + y * mWidth] = cellAt(x, y);
+                if (!cellAt(x, y).isEmpty())
+                    newGrid(x, y) = cellAt(x, y);
                 continue;
             }
 
@@ -373,11 +405,10 @@ void TileLayer::offsetTiles(const QPoint &offset,
                     oldY -= bounds.height();
             }
 
-            // Set the new tile
+            // Set the new tile, leaving empty cells in shared chunks
             if (contains(oldX, oldY) && bounds.contains(oldX, oldY))
-                newGrid[x + y * mWidth] = cellAt(oldX, oldY);
-            else
-                newGrid[x + y * mWidth] = Cell();
+                if (!cellAt(oldX, oldY).isEmpty())
+                    newGrid(x, y) = cellAt(oldX, oldY);
         }
     }
 
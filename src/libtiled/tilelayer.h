@@ -90,6 +90,105 @@ public:
     bool flippedAntiDiagonally;
 };
 
+/**
+ * The storage for the cells of a tile layer. The cells are stored in square
+ * chunks which are implicitly shared, so copying a grid only copies the
+ * references to its chunks. Changing a cell only copies the chunk it is in,
+ * when that chunk is shared.
+ */
+class TILEDSHARED_EXPORT CellGrid
+{
+public:
+    enum {
+        ChunkBits = 4,
+        ChunkSize = 1 << ChunkBits,
+        ChunkMask = ChunkSize - 1
+    };
+
+    /**
+     * Iterates over the cells of a grid, row by row.
+     */
+    class const_iterator
+    {
+    public:
+        const_iterator(const CellGrid *grid, int x, int y)
+            : mGrid(grid), mX(x), mY(y)
+            , mCell(y < grid->mHeight ? &grid->at(x, y) : nullptr)
+        {}
+
+        const Cell &operator*() const { return *mCell; }
+        const Cell *operator->() const { return mCell; }
+
+        const_iterator &operator++()
+        {
+            if (++mX < mGrid->mWidth) {
+                // Cells within a chunk row are adjacent
+                if (mX & ChunkMask)
+                    ++mCell;
+                else
+                    mCell = &mGrid->at(mX, mY);
+            } else {
+                mX = 0;
+                mCell = ++mY < mGrid->mHeight ? &mGrid->at(0, mY) : nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const
+        { return mX == other.mX && mY == other.mY; }
+        bool operator!=(const const_iterator &other) const
+        { return !(*this == other); }
+
+    private:
+        const CellGrid *mGrid;
+        int mX;
+        int mY;
+        const Cell *mCell;
+    };
+
+    CellGrid(int width = 0, int height = 0);
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+
+    const Cell &at(int x, int y) const;
+    Cell &operator()(int x, int y);
+
+    const_iterator begin() const
+    { return const_iterator(this, 0, mWidth > 0 ? 0 : mHeight); }
+    const_iterator end() const
+    { return const_iterator(this, 0, mHeight); }
+
+private:
+    int chunkIndex(int x, int y) const
+    { return (x >> ChunkBits) + (y >> ChunkBits) * ((mWidth + ChunkMask) >> ChunkBits); }
+
+    static int cellIndex(int x, int y)
+    { return (x & ChunkMask) + ((y & ChunkMask) << ChunkBits); }
+
+    int mWidth;
+    int mHeight;
+    QVector<QVector<Cell>> mChunks;
+};
+
+/**
+ * Returns the cell at the given coordinates, which have to be within the
+ * grid.
+ */
+inline const Cell &CellGrid::at(int x, int y) const
+{
+    return mChunks.at(chunkIndex(x, y)).at(cellIndex(x, y));
+}
+
+/**
+ * Returns a modifiable reference to the cell at the given coordinates. This
+ * detaches the chunk containing the cell.
+ */
+inline Cell &CellGrid::operator()(int x, int y)
+{
+    return mChunks[chunkIndex(x, y)][cellIndex(x, y)];
+}
+
 /**
  * A tile layer is a grid of cells. Each cell refers to a specific tile, and
  * stores how the tile is flipped.
@@ -234,16 +333,14 @@ public:
     virtual Layer *clone() const override;
 
     // Enable easy iteration over cells with range-based for
-    QVector<Cell>::iterator begin() { return mGrid.begin(); }
-    QVector<Cell>::iterator end() { return mGrid.end(); }
-    QVector<Cell>::const_iterator begin() const { return mGrid.begin(); }
-    QVector<Cell>::const_iterator end() const { return mGrid.end(); }
+    CellGrid::const_iterator begin() const { return mGrid.begin(); }
+    CellGrid::const_iterator end() const { return mGrid.end(); }
 
 protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
-    QVector<Cell> mGrid;
+    CellGrid mGrid;
     mutable QSet<SharedTileset> mUsedTilesets;
     mutable bool mUsedTilesetsDirty;
 };
@@ -274,7 +371,7 @@ inline QRegion TileLayer::region() const
 inline const Cell &TileLayer::cellAt(int x, int y) const
 {
     Q_ASSERT(contains(x, y));
-    return mGrid.at(x + y * mWidth);
+    return mGrid.at(x, y);
 }
 
 inline const Cell &TileLayer::cellAt(const QPoint &point) const
@@ -31,7 +31,7 @@
 #include "tile.h"
 #include "terrain.h"
 
-#include <QBitmap>
+#include <QCryptographicHash>
 
 using namespace Tiled;
 
@@ -144,7 +144,84 @@ bool Tileset::loadFromImage(const QImage &image,
                             const QString &fileName)
 {
     mImageReference.source = fileName;
+    return loadTiles(image, nullptr);
+}
+
+/**
+ * Reloads this tileset from a changed version of its tileset \a image.
+ * Unlike loadFromImage(), only the tiles of which the pixels changed get a
+ * new image. These tiles are appended to \a changedTiles.
+ *
+ * @return <code>true</code> if loading was successful, otherwise
+ *         returns <code>false</code>
+ */
+bool Tileset::reloadFromImage(const QImage &image, QList<Tile*> &changedTiles)
+{
+    return loadTiles(image, &changedTiles);
+}
+
+/**
+ * Returns the tile in \a rect of the given tileset \a image, with the pixels
+ * of the \a transparentColor made transparent.
+ */
+static QImage sliceTile(const QImage &image, const QRect &rect,
+                        const QColor &transparentColor)
+{
+    QImage tileImage = image.copy(rect);
+    if (!transparentColor.isValid())
+        return tileImage;
+
+    tileImage = tileImage.convertToFormat(QImage::Format_ARGB32);
+    const QRgb transparent = transparentColor.rgb();
+
+    for (int y = 0; y < tileImage.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb*>(tileImage.scanLine(y));
+        for (int x = 0; x < tileImage.width(); ++x)
+            if (line[x] == transparent)
+                line[x] = 0;
+    }
+
+    return tileImage;
+}
+
+/**
+ * Returns a hash of the pixels of the given tile \a image, used to find out
+ * which tiles changed when the tileset image is reloaded.
+ */
+static QByteArray tileImageHash(const QImage &image)
+{
+    const QImage pixels = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    for (int y = 0; y < pixels.height(); ++y)
+        hash.addData(reinterpret_cast<const char*>(pixels.constScanLine(y)),
+                     pixels.width() * 4);
+
+    return hash.result();
+}
+
+/**
+ * Sets the hash of the image of the tile with the given \a id. Returns
+ * whether it was different from before.
+ */
+bool Tileset::updateTileImageHash(int id, const QByteArray &hash)
+{
+    if (id >= mTileImageHashes.size())
+        mTileImageHashes.resize(id + 1);
+    else if (mTileImageHashes.at(id) == hash)
+        return false;
 
+    mTileImageHashes[id] = hash;
+    return true;
+}
+
+/**
+ * Slices the given \a image into tiles. When \a changedTiles is given, tiles
+ * are only updated when their pixels are different from before, and the
+ * updated tiles are appended to the list.
+ */
+bool Tileset::loadTiles(const QImage &image, QList<Tile*> *changedTiles)
+{
     if (image.isNull()) {
         mImageReference.loaded = false;
         return false;
@@ -153,42 +230,75 @@ bool Tileset::loadFromImage(const QImage &image,
     const QSize tileSize = this->tileSize();
     const int margin = this->margin();
     const int spacing = this->tileSpacing();
+    const QColor &transparent = mImageReference.transparentColor;
 
     Q_ASSERT(tileSize.width() > 0 && tileSize.height() > 0);
 
     const int stopWidth = image.width() - tileSize.width();
     const int stopHeight = image.height() - tileSize.height();
 
+    // The hashes are only needed when reloading, so they are taken from the
+    // current tile images on the first reload rather than on every load
+    if (!changedTiles) {
+        mTileImageHashes.clear();
+    } else if (mTileImageHashes.isEmpty()) {
+        for (const Tile *tile : mTiles)
+            updateTileImageHash(tile->id(), tileImageHash(tile->image().toImage()));
+    }
+
     int tileNum = 0;
 
     for (int y = margin; y <= stopHeight; y += tileSize.height() + spacing) {
         for (int x = margin; x <= stopWidth; x += tileSize.width() + spacing) {
-            const QImage tileImage = image.copy(x, y, tileSize.width(), tileSize.height());
-            QPixmap tilePixmap = QPixmap::fromImage(tileImage);
-            const QColor &transparent = mImageReference.transparentColor;
+            const QImage tileImage = sliceTile(image, QRect(QPoint(x, y), tileSize),
+                                               transparent);
+
+            auto it = mTiles.find(tileNum);
 
-            if (transparent.isValid()) {
-                const QImage mask = tileImage.createMaskFromColor(transparent.rgb());
-                tilePixmap.setMask(QBitmap::fromImage(mask));
+            if (changedTiles) {
+                const bool changed = updateTileImageHash(tileNum, tileImageHash(tileImage));
+                if (!changed && it != mTiles.end()) {
+                    ++tileNum;
+                    continue;
+                }
             }
 
-            auto it = mTiles.find(tileNum);
+            const QPixmap tilePixmap = QPixmap::fromImage(tileImage);
+
             if (it != mTiles.end())
                 it.value()->setImage(tilePixmap);
             else
-                mTiles.insert(tileNum, new Tile(tilePixmap, tileNum, this));
+                it = mTiles.insert(tileNum, new Tile(tilePixmap, tileNum, this));
+
+            if (changedTiles)
+                changedTiles->append(it.value());
 
             ++tileNum;
         }
     }
 
     // Blank out any remaining tiles to avoid confusion (todo: could be more clear)
+    QByteArray blankHash;
+
     for (Tile *tile : mTiles) {
-        if (tile->id() >= tileNum) {
-            QPixmap tilePixmap = QPixmap(tileSize);
-            tilePixmap.fill();
-            tile->setImage(tilePixmap);
+        if (tile->id() < tileNum)
+            continue;
+
+        QPixmap tilePixmap = QPixmap(tileSize);
+        tilePixmap.fill();
+
+        // When reloading, tiles that were already blank can be skipped
+        if (changedTiles) {
+            if (blankHash.isEmpty())
+                blankHash = tileImageHash(tilePixmap.toImage());
+            if (!updateTileImageHash(tile->id(), blankHash))
+                continue;
         }
+
+        tile->setImage(tilePixmap);
+
+        if (changedTiles)
+            changedTiles->append(tile);
     }
 
     mNextTileId = std::max(mNextTileId, tileNum);
@@ -139,6 +139,7 @@ public:
     bool loadFromImage(const QImage &image, const QString &fileName);
     bool loadFromImage(const QString &fileName);
     bool loadImage();
+    bool reloadFromImage(const QImage &image, QList<Tile*> &changedTiles);
 
     SharedTileset findSimilarTileset(const QVector<SharedTileset> &tilesets) const;
 
@@ -182,6 +183,8 @@ public:
 private:
     void updateTileSize();
     void recalculateTerrainDistances();
+    bool loadTiles(const QImage &image, QList<Tile*> *changedTiles);
+    bool updateTileImageHash(int id, const QByteArray &hash);
 
     QString mName;
     QString mFileName;
@@ -194,6 +197,7 @@ private:
     int mColumnCount;
     int mExpectedColumnCount;
     QMap<int, Tile*> mTiles;
+    QVector<QByteArray> mTileImageHashes;
     int mNextTileId;
     QList<Terrain*> mTerrainTypes;
     bool mTerrainDistancesDirty;
@@ -33,6 +33,7 @@
 #include "tilesetformat.h"
 
 #include <QScopedPointer>
+#include <QVector>
 
 using namespace Tiled;
 
@@ -365,6 +366,26 @@ TileLayer *VariantToMapConverter::toTileLayer(const QVariantMap &variantMap)
     switch (layerDataFormat) {
     case Map::XML:
     case Map::CSV: {
+        // The global tile IDs may have been stored in a packed array, to
+        // avoid the overhead of a QVariant for each tile
+        if (dataVariant.userType() == qMetaTypeId<QVector<unsigned>>()) {
+            const QVector<unsigned> gids = dataVariant.value<QVector<unsigned>>();
+
+            if (gids.size() != width * height) {
+                mError = tr("Corrupt layer data for layer '%1'").arg(name);
+                return nullptr;
+            }
+
+            const unsigned *gid = gids.constData();
+            bool ok;
+
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x)
+                    tileLayer->setCell(x, y, mGidMapper.gidToCell(*gid++, ok));
+
+            break;
+        }
+
         const QVariantList dataVariantList = dataVariant.toList();
 
         if (dataVariantList.size() != width * height) {
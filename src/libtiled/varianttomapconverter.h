@@ -39,6 +39,9 @@ class Tileset;
 /**
  * Converts a QVariant to a Map instance. Meant to be used together with
  * JsonReader.
+ *
+ * Apart from a QVariantList, the tile layer data may also be provided as a
+ * QVector<unsigned> of global tile IDs.
  */
 class TILEDSHARED_EXPORT VariantToMapConverter
 {
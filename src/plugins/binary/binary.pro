@@ -0,0 +1,7 @@
+include(../plugin.pri)
+
+DEFINES += BINARY_LIBRARY
+
+SOURCES += binaryplugin.cpp
+HEADERS += binaryplugin.h \
+    binary_global.h
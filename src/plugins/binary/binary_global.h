@@ -0,0 +1,32 @@
+/*
+ * Binary Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARY_GLOBAL_H
+#define BINARY_GLOBAL_H
+
+#include <QtCore/qglobal.h>
+
+#if defined(BINARY_LIBRARY)
+#  define BINARYSHARED_EXPORT Q_DECL_EXPORT
+#else
+#  define BINARYSHARED_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif // BINARY_GLOBAL_H
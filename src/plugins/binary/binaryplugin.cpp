@@ -0,0 +1,644 @@
+/*
+ * Binary Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binaryplugin.h"
+
+#include "compression.h"
+#include "gidmapper.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "maptovariantconverter.h"
+#include "objectgroup.h"
+#include "properties.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "varianttomapconverter.h"
+
+#include <QColor>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPolygonF>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace Tiled;
+using namespace Binary;
+
+namespace {
+
+const char Magic[4] = { 'T', 'B', 'M', 'P' };
+const quint16 FormatVersion = 1;
+
+// magic, version, reserved, metadata offset and metadata size
+const int HeaderSize = 4 + 2 + 2 + 8 + 8;
+
+// Chunk data starts at offsets that are a multiple of this value
+const int ChunkAlignment = 16;
+
+// Tile layers are split up in chunks of at most this many tiles squared
+const int ChunkSize = 64;
+
+enum LayerType : quint8 {
+    TileLayerType,
+    ObjectGroupType,
+    ImageLayerType
+};
+
+enum ChunkCompression : quint8 {
+    Uncompressed,
+    ZlibCompressed
+};
+
+struct Chunk
+{
+    qint32 x;
+    qint32 y;
+    qint32 width;
+    qint32 height;
+    quint8 compression;
+    quint64 offset;
+    quint32 size;
+};
+
+QDataStream &operator<<(QDataStream &out, const Chunk &chunk)
+{
+    out << chunk.x << chunk.y << chunk.width << chunk.height
+        << chunk.compression << chunk.offset << chunk.size;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, Chunk &chunk)
+{
+    in >> chunk.x >> chunk.y >> chunk.width >> chunk.height
+       >> chunk.compression >> chunk.offset >> chunk.size;
+    return in;
+}
+
+void setupStream(QDataStream &stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setVersion(QDataStream::Qt_5_0);
+}
+
+QString resolvePath(const QDir &dir, const QString &fileName)
+{
+    if (!fileName.isEmpty() && QDir::isRelativePath(fileName))
+        return QDir::cleanPath(dir.absoluteFilePath(fileName));
+    return fileName;
+}
+
+void writeProperties(QDataStream &out, const Properties &properties,
+                     const QDir &dir)
+{
+    out << quint32(properties.size());
+
+    Properties::const_iterator it = properties.constBegin();
+    Properties::const_iterator it_end = properties.constEnd();
+    for (; it != it_end; ++it) {
+        QVariant value = toExportValue(it.value());
+
+        if (it.value().userType() == filePathTypeId())
+            value = dir.relativeFilePath(value.toString());
+
+        out << it.key() << typeToName(it.value().userType()) << value;
+    }
+}
+
+Properties readProperties(QDataStream &in, const QDir &dir)
+{
+    Properties properties;
+
+    quint32 count;
+    in >> count;
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        QString typeName;
+        QVariant value;
+        in >> name >> typeName >> value;
+
+        int type = nameToType(typeName);
+        if (type == QVariant::Invalid)
+            type = QVariant::String;
+
+        if (type == filePathTypeId())
+            value = resolvePath(dir, value.toString());
+
+        properties.insert(name, fromExportValue(value, type));
+    }
+
+    return properties;
+}
+
+void writeLayerAttributes(QDataStream &out, const Layer *layer,
+                          const QDir &dir)
+{
+    out << layer->name()
+        << qint32(layer->x()) << qint32(layer->y())
+        << qint32(layer->width()) << qint32(layer->height())
+        << layer->isVisible() << double(layer->opacity())
+        << layer->offset();
+
+    writeProperties(out, layer->properties(), dir);
+}
+
+void readLayerAttributes(QDataStream &in, Layer *layer, const QDir &dir)
+{
+    bool visible;
+    double opacity;
+    QPointF offset;
+    in >> visible >> opacity >> offset;
+
+    layer->setVisible(visible);
+    layer->setOpacity(opacity);
+    layer->setOffset(offset);
+    layer->setProperties(readProperties(in, dir));
+}
+
+/**
+ * Writes padding to \a device until its position is aligned.
+ */
+void align(QIODevice *device)
+{
+    static const char padding[ChunkAlignment] = {};
+    const int remainder = device->pos() % ChunkAlignment;
+    if (remainder != 0)
+        device->write(padding, ChunkAlignment - remainder);
+}
+
+} // anonymous namespace
+
+
+BinaryPlugin::BinaryPlugin()
+{
+}
+
+Map *BinaryPlugin::read(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = tr("Could not open file for reading.");
+        return nullptr;
+    }
+
+    const qint64 fileSize = file.size();
+    if (fileSize < HeaderSize) {
+        mError = tr("Not a binary map file.");
+        return nullptr;
+    }
+
+    // Map the file, so that layer data can be decoded without first reading
+    // it into memory. Fall back to reading it when mapping is not possible.
+    QByteArray contents;
+    const uchar *data = file.map(0, fileSize);
+    if (!data) {
+        contents = file.readAll();
+        if (contents.size() != fileSize) {
+            mError = file.errorString();
+            return nullptr;
+        }
+        data = reinterpret_cast<const uchar*>(contents.constData());
+    }
+
+    if (memcmp(data, Magic, sizeof(Magic)) != 0) {
+        mError = tr("Not a binary map file.");
+        return nullptr;
+    }
+
+    const quint16 version = qFromLittleEndian<quint16>(data + 4);
+    if (version != FormatVersion) {
+        mError = tr("Unsupported binary map version: %1").arg(version);
+        return nullptr;
+    }
+
+    const quint64 metadataOffset = qFromLittleEndian<quint64>(data + 8);
+    const quint64 metadataSize = qFromLittleEndian<quint64>(data + 16);
+    if (metadataOffset < quint64(HeaderSize) ||
+            metadataOffset > quint64(fileSize) ||
+            metadataSize > quint64(fileSize) - metadataOffset) {
+        mError = tr("Corrupt binary map file.");
+        return nullptr;
+    }
+
+    const QByteArray metadata = QByteArray::fromRawData(
+                reinterpret_cast<const char*>(data + metadataOffset),
+                int(metadataSize));
+    QDataStream in(metadata);
+    setupStream(in);
+
+    const QDir dir = QFileInfo(fileName).dir();
+
+    qint32 orientation, renderOrder, width, height, tileWidth, tileHeight;
+    qint32 hexSideLength, staggerAxis, staggerIndex, nextObjectId;
+    qint32 layerDataFormat;
+    QColor backgroundColor;
+
+    in >> orientation >> renderOrder
+       >> width >> height >> tileWidth >> tileHeight
+       >> hexSideLength >> staggerAxis >> staggerIndex
+       >> nextObjectId >> layerDataFormat >> backgroundColor;
+
+    QScopedPointer<Map> map(new Map(static_cast<Map::Orientation>(orientation),
+                                    width, height, tileWidth, tileHeight));
+    map->setRenderOrder(static_cast<Map::RenderOrder>(renderOrder));
+    map->setHexSideLength(hexSideLength);
+    map->setStaggerAxis(static_cast<Map::StaggerAxis>(staggerAxis));
+    map->setStaggerIndex(static_cast<Map::StaggerIndex>(staggerIndex));
+    if (nextObjectId > 0)
+        map->setNextObjectId(nextObjectId);
+    map->setLayerDataFormat(static_cast<Map::LayerDataFormat>(layerDataFormat));
+    map->setBackgroundColor(backgroundColor);
+    map->setProperties(readProperties(in, dir));
+
+    // Tilesets are stored the same way as for the JSON format
+    GidMapper gidMapper;
+    VariantToMapConverter converter;
+
+    quint32 tilesetCount;
+    in >> tilesetCount;
+
+    for (quint32 i = 0; i < tilesetCount && in.status() == QDataStream::Ok; ++i) {
+        quint32 firstGid;
+        QVariant tilesetVariant;
+        in >> firstGid >> tilesetVariant;
+
+        SharedTileset tileset = converter.toTileset(tilesetVariant, dir);
+        if (!tileset) {
+            mError = converter.errorString();
+            return nullptr;
+        }
+
+        // Tilesets that failed to load are mapped as well, so that their
+        // tiles are kept as placeholders like when reading TMX files
+        map->addTileset(tileset);
+        gidMapper.insert(firstGid, tileset.data());
+    }
+
+    quint32 layerCount;
+    in >> layerCount;
+
+    for (quint32 i = 0; i < layerCount && in.status() == QDataStream::Ok; ++i) {
+        quint8 type;
+        QString name;
+        qint32 x, y, layerWidth, layerHeight;
+        in >> type >> name >> x >> y >> layerWidth >> layerHeight;
+
+        switch (type) {
+        case TileLayerType: {
+            QScopedPointer<TileLayer> tileLayer(new TileLayer(name, x, y,
+                                                              layerWidth,
+                                                              layerHeight));
+            readLayerAttributes(in, tileLayer.data(), dir);
+
+            quint32 chunkCount;
+            in >> chunkCount;
+
+            for (quint32 c = 0; c < chunkCount && in.status() == QDataStream::Ok; ++c) {
+                Chunk chunk;
+                in >> chunk;
+
+                const QRect chunkRect(chunk.x, chunk.y, chunk.width, chunk.height);
+                if (chunk.width <= 0 || chunk.height <= 0 ||
+                        chunk.width > ChunkSize || chunk.height > ChunkSize ||
+                        !QRect(0, 0, layerWidth, layerHeight).contains(chunkRect) ||
+                        chunk.offset > quint64(fileSize) ||
+                        chunk.size > quint64(fileSize) - chunk.offset) {
+                    mError = tr("Corrupt layer data for layer '%1'").arg(name);
+                    return nullptr;
+                }
+
+                const int expectedSize = chunk.width * chunk.height * 4;
+                const uchar *gids = data + chunk.offset;
+                QByteArray uncompressed;
+
+                if (chunk.compression == ZlibCompressed) {
+                    const QByteArray compressed = QByteArray::fromRawData(
+                                reinterpret_cast<const char*>(gids), int(chunk.size));
+                    uncompressed = decompress(compressed, expectedSize);
+                    gids = reinterpret_cast<const uchar*>(uncompressed.constData());
+                    if (uncompressed.size() != expectedSize) {
+                        mError = tr("Corrupt layer data for layer '%1'").arg(name);
+                        return nullptr;
+                    }
+                } else if (chunk.size != quint32(expectedSize)) {
+                    mError = tr("Corrupt layer data for layer '%1'").arg(name);
+                    return nullptr;
+                }
+
+                for (int ty = 0; ty < chunk.height; ++ty) {
+                    for (int tx = 0; tx < chunk.width; ++tx) {
+                        const unsigned gid = qFromLittleEndian<quint32>(gids);
+                        gids += 4;
+
+                        if (!gid)
+                            continue;
+
+                        bool ok;
+                        const Cell cell = gidMapper.gidToCell(gid, ok);
+                        if (!ok) {
+                            mError = tr("Invalid tile: %1").arg(gid);
+                            return nullptr;
+                        }
+
+                        tileLayer->setCell(chunk.x + tx, chunk.y + ty, cell);
+                    }
+                }
+            }
+
+            map->addLayer(tileLayer.take());
+            break;
+        }
+        case ObjectGroupType: {
+            QScopedPointer<ObjectGroup> objectGroup(new ObjectGroup(name, x, y,
+                                                                    layerWidth,
+                                                                    layerHeight));
+            readLayerAttributes(in, objectGroup.data(), dir);
+
+            QColor color;
+            qint32 drawOrder;
+            quint32 objectCount;
+            in >> color >> drawOrder >> objectCount;
+
+            objectGroup->setColor(color);
+            objectGroup->setDrawOrder(static_cast<ObjectGroup::DrawOrder>(drawOrder));
+
+            for (quint32 o = 0; o < objectCount && in.status() == QDataStream::Ok; ++o) {
+                qint32 id;
+                QString objectName, objectType;
+                quint32 gid;
+                QPointF position;
+                QSizeF size;
+                double rotation;
+                bool objectVisible;
+                qint32 shape;
+                QPolygonF polygon;
+
+                in >> id >> objectName >> objectType >> gid
+                   >> position >> size >> rotation >> objectVisible
+                   >> shape >> polygon;
+
+                MapObject *object = new MapObject(objectName, objectType,
+                                                  position, size);
+                object->setId(id);
+                object->setRotation(rotation);
+                object->setVisible(objectVisible);
+                object->setShape(static_cast<MapObject::Shape>(shape));
+                object->setPolygon(polygon);
+                object->setProperties(readProperties(in, dir));
+
+                if (gid) {
+                    bool ok;
+                    object->setCell(gidMapper.gidToCell(gid, ok));
+                }
+
+                objectGroup->addObject(object);
+            }
+
+            map->addLayer(objectGroup.take());
+            break;
+        }
+        case ImageLayerType: {
+            QScopedPointer<ImageLayer> imageLayer(new ImageLayer(name, x, y,
+                                                                 layerWidth,
+                                                                 layerHeight));
+            readLayerAttributes(in, imageLayer.data(), dir);
+
+            QColor transparentColor;
+            QString imageSource;
+            in >> transparentColor >> imageSource;
+
+            imageLayer->setTransparentColor(transparentColor);
+            if (!imageSource.isEmpty())
+                imageLayer->loadFromImage(resolvePath(dir, imageSource));
+
+            map->addLayer(imageLayer.take());
+            break;
+        }
+        default:
+            mError = tr("Unknown layer type: %1").arg(type);
+            return nullptr;
+        }
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        mError = tr("Corrupt binary map file.");
+        return nullptr;
+    }
+
+    return map.take();
+}
+
+bool BinaryPlugin::supportsFile(const QString &fileName) const
+{
+    return fileName.endsWith(QLatin1String(".tbm"), Qt::CaseInsensitive);
+}
+
+bool BinaryPlugin::write(const Map *map, const QString &fileName)
+{
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = tr("Could not open file for writing.");
+        return false;
+    }
+
+    const QDir dir = QFileInfo(fileName).dir();
+    const bool compressChunks = map->layerDataFormat() == Map::Base64Zlib ||
+                                map->layerDataFormat() == Map::Base64Gzip;
+
+    // The header is written again once the metadata offset is known
+    QByteArray header(HeaderSize, '\0');
+    file.write(header);
+
+    QByteArray metadata;
+    QDataStream out(&metadata, QIODevice::WriteOnly);
+    setupStream(out);
+
+    out << qint32(map->orientation()) << qint32(map->renderOrder())
+        << qint32(map->width()) << qint32(map->height())
+        << qint32(map->tileWidth()) << qint32(map->tileHeight())
+        << qint32(map->hexSideLength())
+        << qint32(map->staggerAxis()) << qint32(map->staggerIndex())
+        << qint32(map->nextObjectId())
+        << qint32(map->layerDataFormat())
+        << map->backgroundColor();
+
+    writeProperties(out, map->properties(), dir);
+
+    GidMapper gidMapper;
+    MapToVariantConverter converter;
+
+    out << quint32(map->tilesetCount());
+
+    unsigned firstGid = 1;
+    for (const SharedTileset &tileset : map->tilesets()) {
+        out << quint32(firstGid) << converter.toVariant(*tileset, dir);
+        gidMapper.insert(firstGid, tileset.data());
+        firstGid += tileset->nextTileId();
+    }
+
+    out << quint32(map->layerCount());
+
+    QByteArray chunkData;
+
+    for (const Layer *layer : map->layers()) {
+        switch (layer->layerType()) {
+        case Layer::TileLayerType: {
+            const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+
+            out << quint8(TileLayerType);
+            writeLayerAttributes(out, tileLayer, dir);
+
+            QVector<Chunk> chunks;
+            const QVector<unsigned> layerGids = gidMapper.layerGids(*tileLayer);
+
+            for (int cy = 0; cy < tileLayer->height(); cy += ChunkSize) {
+                for (int cx = 0; cx < tileLayer->width(); cx += ChunkSize) {
+                    Chunk chunk;
+                    chunk.x = cx;
+                    chunk.y = cy;
+                    chunk.width = qMin(ChunkSize, tileLayer->width() - cx);
+                    chunk.height = qMin(ChunkSize, tileLayer->height() - cy);
+                    chunk.compression = Uncompressed;
+
+                    chunkData.resize(chunk.width * chunk.height * 4);
+                    uchar *gids = reinterpret_cast<uchar*>(chunkData.data());
+                    bool empty = true;
+
+                    for (int y = cy; y < cy + chunk.height; ++y) {
+                        for (int x = cx; x < cx + chunk.width; ++x) {
+                            const unsigned gid = layerGids.at(x + y * tileLayer->width());
+                            qToLittleEndian<quint32>(gid, gids);
+                            gids += 4;
+                            empty &= gid == 0;
+                        }
+                    }
+
+                    // Empty chunks are not stored at all
+                    if (empty)
+                        continue;
+
+                    QByteArray stored = chunkData;
+                    if (compressChunks) {
+                        const QByteArray compressed = compress(chunkData, Zlib);
+                        if (!compressed.isEmpty() && compressed.size() < chunkData.size()) {
+                            stored = compressed;
+                            chunk.compression = ZlibCompressed;
+                        }
+                    }
+
+                    align(&file);
+
+                    chunk.offset = file.pos();
+                    chunk.size = stored.size();
+                    file.write(stored);
+
+                    chunks.append(chunk);
+                }
+            }
+
+            out << quint32(chunks.size());
+            for (const Chunk &chunk : chunks)
+                out << chunk;
+            break;
+        }
+        case Layer::ObjectGroupType: {
+            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
+
+            out << quint8(ObjectGroupType);
+            writeLayerAttributes(out, objectGroup, dir);
+
+            out << objectGroup->color()
+                << qint32(objectGroup->drawOrder())
+                << quint32(objectGroup->objectCount());
+
+            for (const MapObject *object : objectGroup->objects()) {
+                out << qint32(object->id())
+                    << object->name()
+                    << object->type()
+                    << quint32(gidMapper.cellToGid(object->cell()))
+                    << object->position()
+                    << object->size()
+                    << double(object->rotation())
+                    << object->isVisible()
+                    << qint32(object->shape())
+                    << object->polygon();
+
+                writeProperties(out, object->properties(), dir);
+            }
+            break;
+        }
+        case Layer::ImageLayerType: {
+            const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
+
+            out << quint8(ImageLayerType);
+            writeLayerAttributes(out, imageLayer, dir);
+
+            QString imageSource;
+            if (!imageLayer->imageSource().isEmpty())
+                imageSource = dir.relativeFilePath(imageLayer->imageSource());
+
+            out << imageLayer->transparentColor() << imageSource;
+            break;
+        }
+        }
+    }
+
+    const quint64 metadataOffset = file.pos();
+    file.write(metadata);
+
+    uchar *headerData = reinterpret_cast<uchar*>(header.data());
+    memcpy(headerData, Magic, sizeof(Magic));
+    qToLittleEndian<quint16>(FormatVersion, headerData + 4);
+    qToLittleEndian<quint64>(metadataOffset, headerData + 8);
+    qToLittleEndian<quint64>(quint64(metadata.size()), headerData + 16);
+
+    file.seek(0);
+    file.write(header);
+
+    if (file.error() != QFile::NoError) {
+        mError = tr("Error while writing file:\n%1").arg(file.errorString());
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString BinaryPlugin::nameFilter() const
+{
+    return tr("Tiled binary map files (*.tbm)");
+}
+
+QString BinaryPlugin::errorString() const
+{
+    return mError;
+}
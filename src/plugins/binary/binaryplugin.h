@@ -0,0 +1,69 @@
+/*
+ * Binary Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARYPLUGIN_H
+#define BINARYPLUGIN_H
+
+#include "binary_global.h"
+
+#include "mapformat.h"
+
+#include <QObject>
+
+namespace Binary {
+
+/**
+ * A compact binary map format, meant for quickly loading large maps.
+ *
+ * The file starts with a fixed size header, which points to a metadata
+ * block at the end of the file. The metadata describes the map, its
+ * tilesets and its layers. The tile layer data is stored as little-endian
+ * global tile IDs in square chunks, each starting at an aligned offset. Empty
+ * chunks are left out, and chunks are zlib compressed when the map uses a
+ * compressed layer data format.
+ *
+ * When reading, the file is memory-mapped and uncompressed chunks are
+ * decoded straight from the mapping.
+ */
+class BINARYSHARED_EXPORT BinaryPlugin : public Tiled::MapFormat
+{
+    Q_OBJECT
+    Q_INTERFACES(Tiled::MapFormat)
+    Q_PLUGIN_METADATA(IID "org.mapeditor.MapFormat" FILE "plugin.json")
+
+public:
+    BinaryPlugin();
+
+    Tiled::Map *read(const QString &fileName) override;
+    bool supportsFile(const QString &fileName) const override;
+
+    bool write(const Tiled::Map *map, const QString &fileName) override;
+    Tiled::MapFormat *clone() const override { return new BinaryPlugin; }
+
+    QString nameFilter() const override;
+    QString errorString() const override;
+
+private:
+    QString mError;
+};
+
+} // namespace Binary
+
+#endif // BINARYPLUGIN_H
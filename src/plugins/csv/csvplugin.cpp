@@ -20,6 +20,8 @@
 
 #include "csvplugin.h"
 
+#include "gidmapper.h"
+#include "layerexport.h"
 #include "map.h"
 #include "tile.h"
 #include "tilelayer.h"
@@ -41,6 +43,17 @@ bool CsvPlugin::write(const Map *map, const QString &fileName)
     // Get file paths for each layer
     QStringList layerPaths = outputFiles(map, fileName);
 
+    // Tiles are written either by ID or their name, if given. -1 is "empty"
+    const GidMapper gidMapper(map->tilesets());
+    const GidTextTable table(map->tilesets(), [] (const Tile *tile) -> QByteArray {
+        const QVariant name = tile->property(QLatin1String("name"));
+        if (name.isValid())
+            return name.toString().toUtf8();
+        return QByteArray::number(tile->id());
+    }, QByteArray("-1"));
+
+    RowFormatter formatter;
+
     // Traverse all tile layers
     uint currentLayer = 0u;
     foreach (const Layer *layer, map->layers()) {
@@ -56,25 +69,22 @@ bool CsvPlugin::write(const Map *map, const QString &fileName)
             return false;
         }
 
-        // Write out tiles either by ID or their name, if given. -1 is "empty"
+        const QVector<unsigned> gids = gidMapper.layerGids(*tileLayer);
+        const int width = tileLayer->width();
+
         for (int y = 0; y < tileLayer->height(); ++y) {
-            for (int x = 0; x < tileLayer->width(); ++x) {
-                if (x > 0)
-                    file.write(",", 1);
-    
-                const Cell &cell = tileLayer->cellAt(x, y);
-                const Tile *tile = cell.tile;
-                if (tile && tile->hasProperty(QLatin1String("name"))) {
-                    file.write(tile->property(QLatin1String("name")).toString().toUtf8());
-                } else {
-                    const int id = tile ? tile->id() : -1;
-                    file.write(QByteArray::number(id));
-                }
+            formatter.appendRow(gids.constData() + y * width, width, table);
+            formatter.append('\n');
+
+            if (formatter.buffer().size() >= 64 * 1024) {
+                file.write(formatter.buffer());
+                formatter.clear();
             }
-    
-            file.write("\n", 1);
         }
-    
+
+        file.write(formatter.buffer());
+        formatter.clear();
+
         if (file.error() != QFile::NoError) {
             mError = file.errorString();
             return false;
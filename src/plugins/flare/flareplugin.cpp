@@ -23,6 +23,7 @@
 #include "flareplugin.h"
 
 #include "gidmapper.h"
+#include "layerexport.h"
 #include "map.h"
 #include "mapobject.h"
 #include "tile.h"
@@ -315,26 +316,31 @@ bool FlarePlugin::write(const Tiled::Map *map, const QString &fileName)
     out << "\n";
 
     GidMapper gidMapper(map->tilesets());
+    RowFormatter formatter;
+
     // write layers
     for (Layer *layer : map->layers()) {
         if (TileLayer *tileLayer = layer->asTileLayer()) {
             out << "[layer]\n";
             out << "type=" << layer->name() << "\n";
             out << "data=\n";
-            for (int y = 0; y < mapHeight; ++y) {
-                for (int x = 0; x < mapWidth; ++x) {
-                    Cell t = tileLayer->cellAt(x, y);
-                    int id = 0;
-                    if (t.tile)
-                        id = gidMapper.cellToGid(t);
-                    out << id;
-                    if (x < mapWidth - 1)
-                        out << ",";
-                }
-                if (y < mapHeight - 1)
-                    out << ",";
-                out << "\n";
+
+            const QVector<unsigned> gids = gidMapper.layerGids(*tileLayer);
+            const int width = tileLayer->width();
+            const int height = tileLayer->height();
+
+            for (int y = 0; y < height; ++y) {
+                formatter.appendRow(gids.constData() + y * width, width);
+                if (y < height - 1)
+                    formatter.append(',');
+                formatter.append('\n');
             }
+
+            // The layer data is written to the file directly
+            out.flush();
+            file.write(formatter.buffer());
+            formatter.clear();
+
             out << "\n";
         }
         if (ObjectGroup *group = layer->asObjectGroup()) {
@@ -1,6 +1,7 @@
 #include "gbaplugin.h"
 
 #include "layer.h"
+#include "layerexport.h"
 #include "map.h"
 #include "mapobject.h"
 #include "objectgroup.h"
@@ -138,12 +139,14 @@ namespace GBA {
       Tiled::TileLayer *layer = anyLayer->asTileLayer();
       if (!layer) continue; //Skip layers that are not tiles
 
+      const QVector<int> tileIds = Tiled::layerTileIds(*layer, emptyTileId);
+
       for (int i = 0; i < layer->height(); ++i)
       {
         for (int j = 0; j < layer->width(); ++j)
         {
-          Tiled::Cell cell = layer->cellAt(j,i);
-          uint16_t tileId = (cell.isEmpty() ? emptyTileId : cell.tile->id()) * scaleFactor * scaleFactor;
+          const Tiled::Cell &cell = layer->cellAt(j,i);
+          uint16_t tileId = tileIds.at(i * layer->width() + j) * scaleFactor * scaleFactor;
 
           for (uint k = 0; k < scaleFactor; ++k)
           {
@@ -206,8 +209,7 @@ namespace GBA {
         data << ".hword ";
         for (int j = 0; j < layer->width(); ++j)
         {
-          Tiled::Cell cell = layer->cellAt(j,i);
-          uint16_t tileId = cell.isEmpty() ? emptyTileId : cell.tile->id();
+          uint16_t tileId = tileIds.at(i * layer->width() + j);
           data << "0x" << QString("%1").arg(tileId, 4, 16, QLatin1Char( '0' ));
           if (j < layer->width()-1) data << ",";
         }
@@ -3,8 +3,14 @@ include(../plugin.pri)
 DEFINES += JSON_LIBRARY
 
 SOURCES += jsonplugin.cpp \
+    jsonmapwriter.cpp \
+    jsonstreamreader.cpp \
+    jsonstreamwriter.cpp \
     qjsonparser/json.cpp
 
 HEADERS += jsonplugin.h \
     json_global.h \
+    jsonmapwriter.h \
+    jsonstreamreader.h \
+    jsonstreamwriter.h \
     qjsonparser/json.h
@@ -0,0 +1,309 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonmapwriter.h"
+
+#include "jsonstreamwriter.h"
+
+#include "imagelayer.h"
+#include "mapobject.h"
+#include "maptovariantconverter.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QColor>
+
+using namespace Tiled;
+
+namespace Json {
+
+static QString colorToString(const QColor &color)
+{
+    if (color.alpha() != 255)
+        return color.name(QColor::HexArgb);
+    return color.name();
+}
+
+JsonMapWriter::JsonMapWriter(JsonStreamWriter &writer, const QDir &mapDir)
+    : mWriter(writer)
+    , mMapDir(mapDir)
+{
+}
+
+/*
+ * The members of each object are written in alphabetical order, since that
+ * is the order in which JsonWriter writes the entries of a QVariantMap.
+ */
+
+void JsonMapWriter::writeMap(const Map *map)
+{
+    mGidMapper = GidMapper(map->tilesets());
+
+    mWriter.beginObject();
+
+    const QColor bgColor = map->backgroundColor();
+    if (bgColor.isValid())
+        mWriter.writeMember("backgroundcolor", colorToString(bgColor));
+
+    mWriter.writeMember("height", map->height());
+
+    if (map->orientation() == Map::Hexagonal)
+        mWriter.writeMember("hexsidelength", map->hexSideLength());
+
+    mWriter.writeKey("layers");
+    mWriter.beginArray();
+    for (const Layer *layer : map->layers()) {
+        switch (layer->layerType()) {
+        case Layer::TileLayerType:
+            writeTileLayer(static_cast<const TileLayer*>(layer),
+                           map->layerDataFormat());
+            break;
+        case Layer::ObjectGroupType:
+            writeObjectGroup(static_cast<const ObjectGroup*>(layer));
+            break;
+        case Layer::ImageLayerType:
+            writeImageLayer(static_cast<const ImageLayer*>(layer));
+            break;
+        }
+    }
+    mWriter.endArray();
+
+    mWriter.writeMember("nextobjectid", map->nextObjectId());
+    mWriter.writeMember("orientation", orientationToString(map->orientation()));
+
+    writeProperties(map->properties());
+
+    mWriter.writeMember("renderorder", renderOrderToString(map->renderOrder()));
+
+    if (map->orientation() == Map::Hexagonal || map->orientation() == Map::Staggered) {
+        mWriter.writeMember("staggeraxis", staggerAxisToString(map->staggerAxis()));
+        mWriter.writeMember("staggerindex", staggerIndexToString(map->staggerIndex()));
+    }
+
+    mWriter.writeMember("tileheight", map->tileHeight());
+
+    // Tilesets are small compared to the layer data, so these are still
+    // converted using MapToVariantConverter.
+    mWriter.writeKey("tilesets");
+    mWriter.beginArray();
+    int firstGid = 1;
+    for (const SharedTileset &tileset : map->tilesets()) {
+        MapToVariantConverter converter;
+        QVariantMap tilesetVariant = converter.toVariant(*tileset, mMapDir).toMap();
+        tilesetVariant[QLatin1String("firstgid")] = firstGid;
+        mWriter.writeValue(QVariant(tilesetVariant));
+        firstGid += tileset->nextTileId();
+    }
+    mWriter.endArray();
+
+    mWriter.writeMember("tilewidth", map->tileWidth());
+    mWriter.writeMember("version", 1.0);
+    mWriter.writeMember("width", map->width());
+
+    mWriter.endObject();
+}
+
+void JsonMapWriter::writeTileLayer(const TileLayer *tileLayer,
+                                   Map::LayerDataFormat format)
+{
+    mWriter.beginObject();
+
+    switch (format) {
+    case Map::XML:
+    case Map::CSV:
+        mWriter.writeKey("data");
+        mWriter.beginArray();
+        for (unsigned gid : mGidMapper.layerGids(*tileLayer))
+            mWriter.writeValue(gid);
+        mWriter.endArray();
+        break;
+    case Map::Base64:
+    case Map::Base64Zlib:
+    case Map::Base64Gzip: {
+        if (format == Map::Base64Zlib)
+            mWriter.writeMember("compression", QLatin1String("zlib"));
+        else if (format == Map::Base64Gzip)
+            mWriter.writeMember("compression", QLatin1String("gzip"));
+
+        const QByteArray layerData = mGidMapper.encodeLayerData(*tileLayer, format);
+        mWriter.writeMember("data", QString::fromLatin1(layerData));
+        mWriter.writeMember("encoding", QLatin1String("base64"));
+        break;
+    }
+    }
+
+    mWriter.writeMember("height", tileLayer->height());
+    mWriter.writeMember("name", tileLayer->name());
+
+    const QPointF offset = tileLayer->offset();
+    if (!offset.isNull()) {
+        mWriter.writeMember("offsetx", offset.x());
+        mWriter.writeMember("offsety", offset.y());
+    }
+
+    mWriter.writeMember("opacity", double(tileLayer->opacity()));
+
+    writeProperties(tileLayer->properties());
+
+    mWriter.writeMember("type", QLatin1String("tilelayer"));
+    mWriter.writeMember("visible", tileLayer->isVisible());
+    mWriter.writeMember("width", tileLayer->width());
+    mWriter.writeMember("x", tileLayer->x());
+    mWriter.writeMember("y", tileLayer->y());
+
+    mWriter.endObject();
+}
+
+void JsonMapWriter::writeObjectGroup(const ObjectGroup *objectGroup)
+{
+    mWriter.beginObject();
+
+    if (objectGroup->color().isValid())
+        mWriter.writeMember("color", colorToString(objectGroup->color()));
+
+    mWriter.writeMember("draworder", drawOrderToString(objectGroup->drawOrder()));
+    mWriter.writeMember("height", objectGroup->height());
+    mWriter.writeMember("name", objectGroup->name());
+
+    mWriter.writeKey("objects");
+    mWriter.beginArray();
+    for (const MapObject *object : objectGroup->objects()) {
+        mWriter.beginObject();
+
+        if (object->shape() == MapObject::Ellipse)
+            mWriter.writeMember("ellipse", true);
+        if (!object->cell().isEmpty())
+            mWriter.writeMember("gid", mGidMapper.cellToGid(object->cell()));
+
+        mWriter.writeMember("height", object->height());
+        mWriter.writeMember("id", object->id());
+        mWriter.writeMember("name", object->name());
+
+        const QPolygonF &polygon = object->polygon();
+        if (!polygon.isEmpty()) {
+            if (object->shape() == MapObject::Polygon)
+                mWriter.writeKey("polygon");
+            else
+                mWriter.writeKey("polyline");
+
+            mWriter.beginArray();
+            for (const QPointF &point : polygon) {
+                mWriter.beginObject();
+                mWriter.writeMember("x", point.x());
+                mWriter.writeMember("y", point.y());
+                mWriter.endObject();
+            }
+            mWriter.endArray();
+        }
+
+        writeProperties(object->properties());
+
+        mWriter.writeMember("rotation", object->rotation());
+        mWriter.writeMember("type", object->type());
+        mWriter.writeMember("visible", object->isVisible());
+        mWriter.writeMember("width", object->width());
+        mWriter.writeMember("x", object->x());
+        mWriter.writeMember("y", object->y());
+
+        mWriter.endObject();
+    }
+    mWriter.endArray();
+
+    const QPointF offset = objectGroup->offset();
+    if (!offset.isNull()) {
+        mWriter.writeMember("offsetx", offset.x());
+        mWriter.writeMember("offsety", offset.y());
+    }
+
+    mWriter.writeMember("opacity", double(objectGroup->opacity()));
+
+    writeProperties(objectGroup->properties());
+
+    mWriter.writeMember("type", QLatin1String("objectgroup"));
+    mWriter.writeMember("visible", objectGroup->isVisible());
+    mWriter.writeMember("width", objectGroup->width());
+    mWriter.writeMember("x", objectGroup->x());
+    mWriter.writeMember("y", objectGroup->y());
+
+    mWriter.endObject();
+}
+
+void JsonMapWriter::writeImageLayer(const ImageLayer *imageLayer)
+{
+    mWriter.beginObject();
+
+    mWriter.writeMember("height", imageLayer->height());
+    mWriter.writeMember("image", mMapDir.relativeFilePath(imageLayer->imageSource()));
+    mWriter.writeMember("name", imageLayer->name());
+
+    const QPointF offset = imageLayer->offset();
+    if (!offset.isNull()) {
+        mWriter.writeMember("offsetx", offset.x());
+        mWriter.writeMember("offsety", offset.y());
+    }
+
+    mWriter.writeMember("opacity", double(imageLayer->opacity()));
+
+    writeProperties(imageLayer->properties());
+
+    const QColor transColor = imageLayer->transparentColor();
+    if (transColor.isValid())
+        mWriter.writeMember("transparentcolor", transColor.name());
+
+    mWriter.writeMember("type", QLatin1String("imagelayer"));
+    mWriter.writeMember("visible", imageLayer->isVisible());
+    mWriter.writeMember("width", imageLayer->width());
+    mWriter.writeMember("x", imageLayer->x());
+    mWriter.writeMember("y", imageLayer->y());
+
+    mWriter.endObject();
+}
+
+/**
+ * Writes the "properties" and "propertytypes" members, which are always
+ * adjacent in alphabetical order.
+ */
+void JsonMapWriter::writeProperties(const Properties &properties)
+{
+    if (properties.isEmpty())
+        return;
+
+    QVariantMap propertiesMap;
+    QVariantMap propertyTypesMap;
+
+    Properties::const_iterator it = properties.constBegin();
+    Properties::const_iterator it_end = properties.constEnd();
+    for (; it != it_end; ++it) {
+        int type = it.value().userType();
+        QVariant value = toExportValue(it.value());
+
+        if (type == filePathTypeId())
+            value = mMapDir.relativeFilePath(value.toString());
+
+        propertiesMap[it.key()] = value;
+        propertyTypesMap[it.key()] = typeToName(type);
+    }
+
+    mWriter.writeMember("properties", QVariant(propertiesMap));
+    mWriter.writeMember("propertytypes", QVariant(propertyTypesMap));
+}
+
+} // namespace Json
@@ -0,0 +1,71 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONMAPWRITER_H
+#define JSONMAPWRITER_H
+
+#include "gidmapper.h"
+#include "map.h"
+#include "properties.h"
+
+#include <QDir>
+
+namespace Tiled {
+class ImageLayer;
+class ObjectGroup;
+class TileLayer;
+}
+
+namespace Json {
+
+class JsonStreamWriter;
+
+/**
+ * Writes a map as JSON by walking it directly, instead of converting it to
+ * a QVariant first like MapToVariantConverter does. This avoids creating a
+ * QVariant for each tile, which matters a lot for large maps.
+ *
+ * The output is identical to stringifying the result of
+ * MapToVariantConverter::toVariant with JsonWriter, so any changes to one
+ * need to be made to the other as well.
+ */
+class JsonMapWriter
+{
+public:
+    JsonMapWriter(JsonStreamWriter &writer, const QDir &mapDir);
+
+    void writeMap(const Tiled::Map *map);
+
+private:
+    void writeTileLayer(const Tiled::TileLayer *tileLayer,
+                        Tiled::Map::LayerDataFormat format);
+    void writeObjectGroup(const Tiled::ObjectGroup *objectGroup);
+    void writeImageLayer(const Tiled::ImageLayer *imageLayer);
+
+    void writeProperties(const Tiled::Properties &properties);
+
+    JsonStreamWriter &mWriter;
+    QDir mMapDir;
+    Tiled::GidMapper mGidMapper;
+};
+
+} // namespace Json
+
+#endif // JSONMAPWRITER_H
@@ -21,6 +21,9 @@
 
 #include "jsonplugin.h"
 
+#include "jsonmapwriter.h"
+#include "jsonstreamreader.h"
+#include "jsonstreamwriter.h"
 #include "maptovariantconverter.h"
 #include "varianttomapconverter.h"
 
@@ -29,7 +32,6 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QSaveFile>
-#include <QTextStream>
 
 namespace Json {
 
@@ -54,7 +56,6 @@ Tiled::Map *JsonMapFormat::read(const QString &fileName)
         return nullptr;
     }
 
-    JsonReader reader;
     QByteArray contents = file.readAll();
     if (mSubFormat == JavaScript && contents.size() > 0 && contents[0] != '{') {
         // Scan past JSONP prefix; look for an open curly at the start of the line
@@ -66,15 +67,16 @@ Tiled::Map *JsonMapFormat::read(const QString &fileName)
             if (contents.endsWith(')')) contents.chop(1);
         }
     }
-    reader.parse(contents);
+    JsonStreamReader reader;
+    JsonVariantBuilder builder;
 
-    const QVariant variant = reader.result();
-
-    if (!variant.isValid()) {
+    if (!reader.parse(contents, &builder)) {
         mError = tr("Error parsing file.");
         return nullptr;
     }
 
+    const QVariant variant = builder.result();
+
     Tiled::VariantToMapConverter converter;
     Tiled::Map *map = converter.toMap(variant, QFileInfo(fileName).dir());
 
@@ -93,45 +95,43 @@ bool JsonMapFormat::write(const Tiled::Map *map, const QString &fileName)
         return false;
     }
 
-    Tiled::MapToVariantConverter converter;
-    QVariant variant = converter.toVariant(map, QFileInfo(fileName).dir());
-
-    JsonWriter writer;
-    writer.setAutoFormatting(true);
-
-    if (!writer.stringify(variant)) {
-        // This can only happen due to coding error
-        mError = writer.errorString();
-        return false;
-    }
+    JsonStreamWriter writer(&file);
 
-    QTextStream out(&file);
     if (mSubFormat == JavaScript) {
         // Trim and escape name
         JsonWriter nameWriter;
         QString baseName = QFileInfo(fileName).baseName();
         nameWriter.stringify(baseName);
-        out << "(function(name,data){\n if(typeof onTileMapLoaded === 'undefined') {\n";
-        out << "  if(typeof TileMaps === 'undefined') TileMaps = {};\n";
-        out << "  TileMaps[name] = data;\n";
-        out << " } else {\n";
-        out << "  onTileMapLoaded(name,data);\n";
-        out << " }\n";
-        out << " if(typeof module === 'object' && module && module.exports) {\n";
-        out << "  module.exports = data;\n";
-        out << " }})(" << nameWriter.result() << ",\n";
-    }
-    out << writer.result();
-    if (mSubFormat == JavaScript) {
-        out << ");";
+        writer.writeRaw("(function(name,data){\n if(typeof onTileMapLoaded === 'undefined') {\n");
+        writer.writeRaw("  if(typeof TileMaps === 'undefined') TileMaps = {};\n");
+        writer.writeRaw("  TileMaps[name] = data;\n");
+        writer.writeRaw(" } else {\n");
+        writer.writeRaw("  onTileMapLoaded(name,data);\n");
+        writer.writeRaw(" }\n");
+        writer.writeRaw(" if(typeof module === 'object' && module && module.exports) {\n");
+        writer.writeRaw("  module.exports = data;\n");
+        writer.writeRaw(" }})(");
+        writer.writeRaw(nameWriter.result().toLatin1().constData());
+        writer.writeRaw(",\n");
     }
-    out.flush();
 
-    if (file.error() != QFile::NoError) {
+    JsonMapWriter mapWriter(writer, QFileInfo(fileName).dir());
+    mapWriter.writeMap(map);
+
+    if (mSubFormat == JavaScript)
+        writer.writeRaw(");");
+
+    if (!writer.flush() || file.error() != QFile::NoError) {
         mError = tr("Error while writing file:\n%1").arg(file.errorString());
         return false;
     }
 
+    if (!writer.errorString().isEmpty()) {
+        // This can only happen due to coding error
+        mError = writer.errorString();
+        return false;
+    }
+
     if (!file.commit()) {
         mError = file.errorString();
         return false;
@@ -176,18 +176,18 @@ Tiled::SharedTileset JsonTilesetFormat::read(const QString &fileName)
         return Tiled::SharedTileset();
     }
 
-    JsonReader reader;
     QByteArray contents = file.readAll();
 
-    reader.parse(contents);
+    JsonStreamReader reader;
+    JsonVariantBuilder builder;
 
-    const QVariant variant = reader.result();
-
-    if (!variant.isValid()) {
+    if (!reader.parse(contents, &builder)) {
         mError = tr("Error parsing file.");
         return Tiled::SharedTileset();
     }
 
+    const QVariant variant = builder.result();
+
     Tiled::VariantToMapConverter converter;
     Tiled::SharedTileset tileset = converter.toTileset(variant,
                                                        QFileInfo(fileName).dir());
@@ -218,21 +218,17 @@ bool JsonTilesetFormat::write(const Tiled::Tileset &tileset,
     Tiled::MapToVariantConverter converter;
     QVariant variant = converter.toVariant(tileset, QFileInfo(fileName).dir());
 
-    JsonWriter writer;
-    writer.setAutoFormatting(true);
+    JsonStreamWriter writer(&file);
+    writer.writeValue(variant);
 
-    if (!writer.stringify(variant)) {
-        // This can only happen due to coding error
-        mError = writer.errorString();
+    if (!writer.flush() || file.error() != QFile::NoError) {
+        mError = tr("Error while writing file:\n%1").arg(file.errorString());
         return false;
     }
 
-    QTextStream out(&file);
-    out << writer.result();
-    out.flush();
-
-    if (file.error() != QFile::NoError) {
-        mError = tr("Error while writing file:\n%1").arg(file.errorString());
+    if (!writer.errorString().isEmpty()) {
+        // This can only happen due to coding error
+        mError = writer.errorString();
         return false;
     }
 
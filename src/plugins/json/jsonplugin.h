@@ -65,6 +65,9 @@ public:
 
     bool write(const Tiled::Map *map, const QString &fileName) override;
 
+    Tiled::MapFormat *clone() const override
+    { return new JsonMapFormat(mSubFormat); }
+
     QString nameFilter() const override;
     QString errorString() const override;
 
@@ -0,0 +1,490 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstreamreader.h"
+
+#include <QTextCodec>
+
+#include <limits>
+
+namespace Json {
+
+static const int MaximumDepth = 512;
+
+/**
+ * Returns the given \a data as UTF-8. Like JsonReader, the encoding is
+ * detected based on a BOM or the pattern of nulls in the first 4 bytes.
+ */
+static QByteArray toUtf8(const QByteArray &data)
+{
+    QTextCodec *codec = QTextCodec::codecForUtfText(data, nullptr);
+
+    if (!codec && data.size() > 3) {
+        const char *bytes = data.constData();
+        int mib = 106; // utf-8
+
+        if (bytes[0] != 0) {
+            if (bytes[1] == 0)
+                mib = bytes[2] != 0 ? 1014 : 1019; // utf-16 le : utf-32 le
+        } else {
+            mib = bytes[1] != 0 ? 1013 : 1018;      // utf-16 be : utf-32 be
+        }
+
+        if (mib != 106)
+            codec = QTextCodec::codecForMib(mib);
+    }
+
+    if (!codec)
+        return data;
+
+    if (codec->mibEnum() == 106) {
+        // Strip the UTF-8 BOM
+        if (data.startsWith("\xEF\xBB\xBF"))
+            return data.mid(3);
+        return data;
+    }
+
+    return codec->toUnicode(data).toUtf8();
+}
+
+JsonStreamReader::JsonStreamReader()
+    : mBegin(nullptr)
+    , mPos(nullptr)
+    , mEnd(nullptr)
+    , mDepth(0)
+    , mHandler(nullptr)
+{
+}
+
+/**
+ * Parses the JSON document in \a data, reporting its contents to the given
+ * \a handler. Returns whether the document was parsed successfully. If not,
+ * the error can be obtained using errorString().
+ */
+bool JsonStreamReader::parse(const QByteArray &data, JsonHandler *handler)
+{
+    const QByteArray utf8 = toUtf8(data);
+
+    mBegin = utf8.constData();
+    mPos = mBegin;
+    mEnd = mBegin + utf8.size();
+    mDepth = 0;
+    mHandler = handler;
+    mError.clear();
+
+    skipWhitespace();
+    if (!parseValue())
+        return false;
+
+    skipWhitespace();
+    if (mPos != mEnd)
+        return error("unexpected data after document");
+
+    return true;
+}
+
+bool JsonStreamReader::parseValue()
+{
+    if (mPos == mEnd)
+        return error("unexpected end of file");
+
+    switch (*mPos) {
+    case '{':
+        return parseObject();
+    case '[':
+        return parseArray();
+    case '"': {
+        QString string;
+        if (!parseString(string))
+            return false;
+        mHandler->value(string);
+        return true;
+    }
+    case '-':
+    case '+':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return parseNumber();
+    default:
+        return parseKeyword();
+    }
+}
+
+bool JsonStreamReader::parseObject()
+{
+    if (++mDepth > MaximumDepth)
+        return error("maximum nesting depth exceeded");
+
+    ++mPos; // skip {
+    mHandler->beginObject();
+
+    skipWhitespace();
+    if (mPos != mEnd && *mPos == '}') {
+        ++mPos;
+        --mDepth;
+        mHandler->endObject();
+        return true;
+    }
+
+    QString key;
+
+    while (true) {
+        if (mPos == mEnd || *mPos != '"')
+            return error("expected a string");
+        if (!parseString(key))
+            return false;
+
+        mHandler->key(key);
+
+        skipWhitespace();
+        if (mPos == mEnd || *mPos != ':')
+            return error("expected ':'");
+        ++mPos;
+
+        skipWhitespace();
+        if (!parseValue())
+            return false;
+
+        skipWhitespace();
+        if (mPos == mEnd)
+            return error("unexpected end of file");
+
+        if (*mPos == ',') {
+            ++mPos;
+            skipWhitespace();
+        } else if (*mPos == '}') {
+            ++mPos;
+            break;
+        } else {
+            return error("expected ',' or '}'");
+        }
+    }
+
+    --mDepth;
+    mHandler->endObject();
+    return true;
+}
+
+bool JsonStreamReader::parseArray()
+{
+    if (++mDepth > MaximumDepth)
+        return error("maximum nesting depth exceeded");
+
+    ++mPos; // skip [
+    mHandler->beginArray();
+
+    skipWhitespace();
+    if (mPos != mEnd && *mPos == ']') {
+        ++mPos;
+        --mDepth;
+        mHandler->endArray();
+        return true;
+    }
+
+    while (true) {
+        if (!parseValue())
+            return false;
+
+        skipWhitespace();
+        if (mPos == mEnd)
+            return error("unexpected end of file");
+
+        if (*mPos == ',') {
+            ++mPos;
+            skipWhitespace();
+        } else if (*mPos == ']') {
+            ++mPos;
+            break;
+        } else {
+            return error("expected ',' or ']'");
+        }
+    }
+
+    --mDepth;
+    mHandler->endArray();
+    return true;
+}
+
+bool JsonStreamReader::parseString(QString &string)
+{
+    ++mPos; // skip "
+
+    // Fast path for strings without escape sequences
+    const char *start = mPos;
+    while (mPos != mEnd && *mPos != '"' && *mPos != '\\')
+        ++mPos;
+
+    if (mPos == mEnd)
+        return error("unterminated string");
+
+    string = QString::fromUtf8(start, int(mPos - start));
+
+    while (*mPos != '"') {
+        if (*mPos == '\\') {
+            if (++mPos == mEnd)
+                return error("unterminated string");
+
+            switch (*mPos) {
+            case 'b': string += QLatin1Char('\b'); break;
+            case 'f': string += QLatin1Char('\f'); break;
+            case 'n': string += QLatin1Char('\n'); break;
+            case 'r': string += QLatin1Char('\r'); break;
+            case 't': string += QLatin1Char('\t'); break;
+            case 'u': {
+                if (mEnd - mPos < 5)
+                    return error("invalid escape sequence");
+
+                bool ok;
+                const ushort unicode = QByteArray(mPos + 1, 4).toUShort(&ok, 16);
+                if (!ok)
+                    return error("invalid escape sequence");
+
+                string += QChar(unicode);
+                mPos += 4;
+                break;
+            }
+            default:
+                // Includes \", \\ and \/
+                string += QLatin1Char(*mPos);
+                break;
+            }
+
+            ++mPos;
+        }
+
+        start = mPos;
+        while (mPos != mEnd && *mPos != '"' && *mPos != '\\')
+            ++mPos;
+
+        if (mPos == mEnd)
+            return error("unterminated string");
+
+        string += QString::fromUtf8(start, int(mPos - start));
+    }
+
+    ++mPos; // skip "
+    return true;
+}
+
+/**
+ * Parses a number the same way as the lexer used by JsonReader, which
+ * reports integers as qlonglong and any number containing a '.', 'e' or 'E'
+ * as double. Integers that don't fit in a qlonglong are reported as double
+ * as well.
+ */
+bool JsonStreamReader::parseNumber()
+{
+    const char *start = mPos;
+    bool negative = false;
+    bool hasDigits = false;
+    bool isDouble = false;
+    bool overflow = false;
+    quint64 magnitude = 0;
+
+    if (*mPos == '-' || *mPos == '+') {
+        negative = *mPos == '-';
+        ++mPos;
+    }
+
+    for (; mPos != mEnd; ++mPos) {
+        const char c = *mPos;
+        if (c >= '0' && c <= '9') {
+            hasDigits = true;
+            if (isDouble || overflow)
+                continue;
+
+            const unsigned digit = unsigned(c - '0');
+            if (magnitude > (std::numeric_limits<quint64>::max() - digit) / 10)
+                overflow = true;
+            else
+                magnitude = magnitude * 10 + digit;
+        } else if (c == '.') {
+            isDouble = true;
+        } else if (c == 'e' || c == 'E') {
+            isDouble = true;
+
+            // The exponent is the only other place where a sign may appear
+            if (mPos + 1 != mEnd && (mPos[1] == '-' || mPos[1] == '+'))
+                ++mPos;
+        } else {
+            break;
+        }
+    }
+
+    if (!hasDigits)
+        return error("invalid number");
+
+    // The magnitude of the smallest qlonglong is one larger than the largest
+    const quint64 limit = quint64(std::numeric_limits<qlonglong>::max()) + (negative ? 1 : 0);
+    if (magnitude > limit)
+        overflow = true;
+
+    if (isDouble || overflow) {
+        bool ok;
+        const double d = QByteArray::fromRawData(start, int(mPos - start)).toDouble(&ok);
+        if (!ok)
+            return error("invalid number");
+        mHandler->value(d);
+    } else if (negative && magnitude > 0) {
+        mHandler->integer(-qlonglong(magnitude - 1) - 1);
+    } else {
+        mHandler->integer(qlonglong(magnitude));
+    }
+
+    return true;
+}
+
+bool JsonStreamReader::parseKeyword()
+{
+    const char *start = mPos;
+    while (mPos != mEnd && *mPos >= 'a' && *mPos <= 'z')
+        ++mPos;
+
+    const QByteArray keyword = QByteArray::fromRawData(start, int(mPos - start));
+
+    if (keyword == "true")
+        mHandler->value(true);
+    else if (keyword == "false")
+        mHandler->value(false);
+    else if (keyword == "null")
+        mHandler->value(QVariant());
+    else
+        return error("unexpected token");
+
+    return true;
+}
+
+void JsonStreamReader::skipWhitespace()
+{
+    while (mPos != mEnd && (*mPos == ' ' || *mPos == '\n' ||
+                            *mPos == '\r' || *mPos == '\t'))
+        ++mPos;
+}
+
+bool JsonStreamReader::error(const char *message)
+{
+    int line = 1;
+    for (const char *c = mBegin; c != mPos; ++c)
+        if (*c == '\n')
+            ++line;
+
+    mError = QString::fromLatin1("%1 at line %2")
+            .arg(QLatin1String(message)).arg(line);
+    return false;
+}
+
+
+void JsonVariantBuilder::beginObject()
+{
+    if (!mStack.isEmpty() && mStack.last().packed)
+        unpack(mStack.last());
+
+    Frame frame;
+    frame.isObject = true;
+    frame.packed = false;
+    mStack.append(frame);
+}
+
+void JsonVariantBuilder::key(const QString &key)
+{
+    mStack.last().key = key;
+}
+
+void JsonVariantBuilder::endObject()
+{
+    const QVariantMap map = mStack.last().map;
+    mStack.removeLast();
+    add(map);
+}
+
+void JsonVariantBuilder::beginArray()
+{
+    if (!mStack.isEmpty() && mStack.last().packed)
+        unpack(mStack.last());
+
+    Frame frame;
+    frame.isObject = false;
+
+    // Tile layer data is packed, until a value is found that doesn't fit
+    frame.packed = !mStack.isEmpty() && mStack.last().isObject &&
+            mStack.last().key == QLatin1String("data");
+
+    mStack.append(frame);
+}
+
+void JsonVariantBuilder::endArray()
+{
+    const Frame &frame = mStack.last();
+    const QVariant value = frame.packed ? QVariant::fromValue(frame.gids)
+                                        : QVariant(frame.list);
+    mStack.removeLast();
+    add(value);
+}
+
+void JsonVariantBuilder::integer(qlonglong value)
+{
+    if (!mStack.isEmpty() && mStack.last().packed) {
+        Frame &frame = mStack.last();
+        if (value >= 0 && value <= 0xFFFFFFFFLL) {
+            frame.gids.append(unsigned(value));
+            return;
+        }
+        unpack(frame);
+    }
+
+    add(value);
+}
+
+void JsonVariantBuilder::value(const QVariant &value)
+{
+    if (!mStack.isEmpty() && mStack.last().packed)
+        unpack(mStack.last());
+
+    add(value);
+}
+
+/**
+ * Converts the packed global tile IDs of \a frame back to a regular list.
+ */
+void JsonVariantBuilder::unpack(Frame &frame)
+{
+    frame.list.reserve(frame.gids.size());
+    for (unsigned gid : frame.gids)
+        frame.list.append(qlonglong(gid));
+
+    frame.gids.clear();
+    frame.packed = false;
+}
+
+void JsonVariantBuilder::add(const QVariant &value)
+{
+    if (mStack.isEmpty()) {
+        mResult = value;
+        return;
+    }
+
+    Frame &frame = mStack.last();
+    if (frame.isObject)
+        frame.map.insert(frame.key, value);
+    else
+        frame.list.append(value);
+}
+
+} // namespace Json
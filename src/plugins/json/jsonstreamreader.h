@@ -0,0 +1,136 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+namespace Json {
+
+/**
+ * Receives the events reported by JsonStreamReader.
+ */
+class JsonHandler
+{
+public:
+    virtual ~JsonHandler() {}
+
+    virtual void beginObject() = 0;
+    virtual void key(const QString &key) = 0;
+    virtual void endObject() = 0;
+
+    virtual void beginArray() = 0;
+    virtual void endArray() = 0;
+
+    /**
+     * Reports an integer. Reported separately from other values so that
+     * large arrays of integers can be handled without creating a QVariant
+     * for each of them.
+     */
+    virtual void integer(qlonglong value) = 0;
+
+    /**
+     * Reports a string, a floating point number, a boolean or null (as an
+     * invalid QVariant).
+     */
+    virtual void value(const QVariant &value) = 0;
+};
+
+/**
+ * An event-driven JSON parser. Rather than building up a tree, it reports
+ * the structure and values of the document to a JsonHandler while parsing.
+ *
+ * The data is parsed as UTF-8 directly, without converting the whole
+ * document to a QString first.
+ */
+class JsonStreamReader
+{
+public:
+    JsonStreamReader();
+
+    bool parse(const QByteArray &data, JsonHandler *handler);
+
+    QString errorString() const { return mError; }
+
+private:
+    bool parseValue();
+    bool parseObject();
+    bool parseArray();
+    bool parseString(QString &string);
+    bool parseNumber();
+    bool parseKeyword();
+
+    void skipWhitespace();
+    bool error(const char *message);
+
+    const char *mBegin;
+    const char *mPos;
+    const char *mEnd;
+    int mDepth;
+    JsonHandler *mHandler;
+    QString mError;
+};
+
+/**
+ * Builds the same QVariant tree as JsonReader, except that arrays of
+ * non-negative integers stored under a "data" key are stored as a packed
+ * QVector<unsigned>, as supported by VariantToMapConverter for tile layer
+ * data.
+ */
+class JsonVariantBuilder : public JsonHandler
+{
+public:
+    QVariant result() const { return mResult; }
+
+    void beginObject() override;
+    void key(const QString &key) override;
+    void endObject() override;
+
+    void beginArray() override;
+    void endArray() override;
+
+    void integer(qlonglong value) override;
+    void value(const QVariant &value) override;
+
+private:
+    struct Frame
+    {
+        bool isObject;
+        bool packed;
+        QVariantMap map;
+        QVariantList list;
+        QVector<unsigned> gids;
+        QString key;
+    };
+
+    void unpack(Frame &frame);
+    void add(const QVariant &value);
+
+    QVector<Frame> mStack;
+    QVariant mResult;
+};
+
+} // namespace Json
+
+#endif // JSONSTREAMREADER_H
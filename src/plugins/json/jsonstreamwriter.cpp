@@ -0,0 +1,336 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstreamwriter.h"
+
+#include <QIODevice>
+#include <QtNumeric>
+
+#include <cstring>
+
+namespace Json {
+
+static const int FlushThreshold = 64 * 1024;
+
+JsonStreamWriter::JsonStreamWriter(QIODevice *device)
+    : mDevice(device)
+{
+    mBuffer.reserve(FlushThreshold + 1024);
+}
+
+JsonStreamWriter::~JsonStreamWriter()
+{
+    flush();
+}
+
+void JsonStreamWriter::beginObject()
+{
+    beginValue();
+    openObject();
+}
+
+void JsonStreamWriter::endObject()
+{
+    Q_ASSERT(!mContainers.isEmpty() && mContainers.last().type == Object);
+    mContainers.removeLast();
+
+    mBuffer += '\n';
+    writeIndent(mContainers.size());
+    mBuffer += '}';
+}
+
+void JsonStreamWriter::beginArray()
+{
+    beginValue();
+    openArray();
+}
+
+void JsonStreamWriter::endArray()
+{
+    Q_ASSERT(!mContainers.isEmpty() && mContainers.last().type == Array);
+    mContainers.removeLast();
+    mBuffer += ']';
+}
+
+void JsonStreamWriter::writeKey(const char *key)
+{
+    writeKey(QString::fromLatin1(key));
+}
+
+void JsonStreamWriter::writeKey(const QString &key)
+{
+    Q_ASSERT(!mContainers.isEmpty() && mContainers.last().type == Object);
+    Container &container = mContainers.last();
+
+    if (!container.first)
+        mBuffer += ",\n";
+    container.first = false;
+
+    writeIndent(mContainers.size() - 1);
+    mBuffer += ' ';
+    writeString(key);
+    mBuffer += ':';
+}
+
+void JsonStreamWriter::writeValue(int value)
+{
+    beginValue();
+    writeNumber(QByteArray::number(value));
+}
+
+void JsonStreamWriter::writeValue(unsigned value)
+{
+    beginValue();
+    writeNumber(QByteArray::number(value));
+}
+
+void JsonStreamWriter::writeValue(double value)
+{
+    beginValue();
+    if (qIsFinite(value))
+        writeNumber(QByteArray::number(value, 'g', 15));
+    else
+        mBuffer += "null";
+}
+
+void JsonStreamWriter::writeValue(bool value)
+{
+    beginValue();
+    mBuffer += value ? "true" : "false";
+}
+
+void JsonStreamWriter::writeValue(const QString &value)
+{
+    beginValue();
+    writeString(value);
+}
+
+void JsonStreamWriter::writeValue(QLatin1String value)
+{
+    writeValue(QString(value));
+}
+
+void JsonStreamWriter::writeValue(const QVariant &value)
+{
+    beginValue();
+    writeVariant(value);
+}
+
+/**
+ * Writes \a data as-is, for example to wrap the JSON document.
+ */
+void JsonStreamWriter::writeRaw(const char *data)
+{
+    mBuffer.append(data, int(std::strlen(data)));
+}
+
+/**
+ * Writes any buffered output to the device. Returns whether writing to the
+ * device succeeded.
+ */
+bool JsonStreamWriter::flush()
+{
+    if (mBuffer.isEmpty())
+        return true;
+
+    const qint64 written = mDevice->write(mBuffer);
+    mBuffer.resize(0); // keeps the reserved capacity
+
+    if (written == -1) {
+        mError = mDevice->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the separator between array elements when necessary.
+ */
+void JsonStreamWriter::beginValue()
+{
+    if (mBuffer.size() >= FlushThreshold)
+        flush();
+
+    if (mContainers.isEmpty())
+        return;
+
+    Container &container = mContainers.last();
+    if (container.type != Array)
+        return;
+
+    if (!container.first)
+        mBuffer += ", ";
+    container.first = false;
+}
+
+void JsonStreamWriter::openObject()
+{
+    // Nested objects start on a new line
+    const int depth = mContainers.size();
+    if (depth != 0) {
+        mBuffer += '\n';
+        writeIndent(depth);
+        mBuffer += "{\n";
+    } else {
+        mBuffer += '{';
+    }
+
+    mContainers.append(Container { Object, true });
+}
+
+void JsonStreamWriter::openArray()
+{
+    mBuffer += '[';
+    mContainers.append(Container { Array, true });
+}
+
+void JsonStreamWriter::writeIndent(int depth)
+{
+    for (int i = 0; i < depth; ++i)
+        mBuffer += "    ";
+}
+
+/**
+ * Writes the given \a string as a JSON string, with the same escaping as
+ * done by JsonWriter.
+ */
+void JsonStreamWriter::writeString(const QString &string)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    mBuffer += '\"';
+
+    for (const QChar c : string) {
+        const ushort u = c.unicode();
+        switch (u) {
+        case '\b': mBuffer += "\\b"; break;
+        case '\f': mBuffer += "\\f"; break;
+        case '\n': mBuffer += "\\n"; break;
+        case '\r': mBuffer += "\\r"; break;
+        case '\t': mBuffer += "\\t"; break;
+        case '\"': mBuffer += "\\\""; break;
+        case '\\': mBuffer += "\\\\"; break;
+        case '/':  mBuffer += "\\/"; break;
+        default:
+            if (u > 127) {
+                mBuffer += "\\u";
+                mBuffer += hexDigits[(u >> 12) & 0xF];
+                mBuffer += hexDigits[(u >> 8) & 0xF];
+                mBuffer += hexDigits[(u >> 4) & 0xF];
+                mBuffer += hexDigits[u & 0xF];
+            } else {
+                mBuffer += char(u);
+            }
+        }
+    }
+
+    mBuffer += '\"';
+}
+
+void JsonStreamWriter::writeNumber(const QByteArray &number)
+{
+    mBuffer += number;
+}
+
+/**
+ * Writes the given \a variant, following the same conversion rules as
+ * JsonWriter::stringify.
+ */
+void JsonStreamWriter::writeVariant(const QVariant &variant)
+{
+    switch (int(variant.type())) {
+    case QVariant::List:
+    case QVariant::StringList: {
+        openArray();
+        const QVariantList list = variant.toList();
+        for (const QVariant &value : list)
+            writeValue(value);
+        endArray();
+        return;
+    }
+    case QVariant::Map: {
+        openObject();
+        const QVariantMap map = variant.toMap();
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            writeKey(it.key());
+            writeValue(it.value());
+        }
+
+        endObject();
+        return;
+    }
+    case QVariant::String:
+    case QVariant::ByteArray:
+        writeString(variant.toString());
+        return;
+    case QVariant::Double:
+    case QMetaType::Float: {
+        const double d = variant.toDouble();
+        if (qIsFinite(d))
+            writeNumber(QByteArray::number(d, 'g', 15));
+        else
+            mBuffer += "null";
+        return;
+    }
+    case QVariant::Bool:
+        mBuffer += variant.toBool() ? "true" : "false";
+        return;
+    case QVariant::Invalid:
+        mBuffer += "null";
+        return;
+    case QVariant::ULongLong:
+        writeNumber(QByteArray::number(variant.toULongLong()));
+        return;
+    case QVariant::LongLong:
+        writeNumber(QByteArray::number(variant.toLongLong()));
+        return;
+    case QVariant::Int:
+        writeNumber(QByteArray::number(variant.toInt()));
+        return;
+    case QVariant::UInt:
+        writeNumber(QByteArray::number(variant.toUInt()));
+        return;
+    case QVariant::Char: {
+        // Unlike strings, characters are not escaped by JsonWriter
+        const ushort u = variant.toChar().unicode();
+        if (u > 127)
+            mBuffer += "\"\\u" + QByteArray::number(u, 16).rightJustified(4, '0') + '\"';
+        else
+            mBuffer += '\"' + QByteArray(1, char(u)) + '\"';
+        return;
+    }
+    }
+
+    if (variant.canConvert<qlonglong>()) {
+        writeNumber(QByteArray::number(variant.toLongLong()));
+    } else if (variant.canConvert<QString>()) {
+        writeString(variant.toString());
+    } else {
+        if (!mError.isEmpty())
+            mError.append(QLatin1Char('\n'));
+        mError.append(QString::fromLatin1("Unsupported type %1 (id: %2)")
+                      .arg(QString::fromUtf8(variant.typeName()))
+                      .arg(variant.userType()));
+        mBuffer += "null";
+    }
+}
+
+} // namespace Json
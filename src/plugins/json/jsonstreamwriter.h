@@ -0,0 +1,115 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAMWRITER_H
+#define JSONSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+class QIODevice;
+
+namespace Json {
+
+/**
+ * Writes JSON to a device while it is being generated, rather than building
+ * up the whole document in memory first.
+ *
+ * The output is formatted exactly like the output of JsonWriter with auto
+ * formatting enabled. Since all non-ASCII characters are escaped, the output
+ * is plain ASCII and hence also valid UTF-8.
+ *
+ * Object members need to be written in alphabetical order of their keys to
+ * match the output of JsonWriter, which writes QVariantMap entries.
+ */
+class JsonStreamWriter
+{
+public:
+    explicit JsonStreamWriter(QIODevice *device);
+    ~JsonStreamWriter();
+
+    void beginObject();
+    void endObject();
+
+    void beginArray();
+    void endArray();
+
+    void writeKey(const char *key);
+    void writeKey(const QString &key);
+
+    void writeValue(int value);
+    void writeValue(unsigned value);
+    void writeValue(double value);
+    void writeValue(bool value);
+    void writeValue(const QString &value);
+    void writeValue(QLatin1String value);
+    void writeValue(const QVariant &value);
+
+    /**
+     * Convenience function for writing an object member.
+     */
+    template<typename T>
+    void writeMember(const char *key, const T &value)
+    {
+        writeKey(key);
+        writeValue(value);
+    }
+
+    void writeRaw(const char *data);
+
+    bool flush();
+
+    /**
+     * Returns the reason of the last failure, when writing a value of an
+     * unsupported type or when writing to the device failed.
+     */
+    QString errorString() const { return mError; }
+
+private:
+    void beginValue();
+    void openObject();
+    void openArray();
+    void writeIndent(int depth);
+    void writeString(const QString &string);
+    void writeNumber(const QByteArray &number);
+    void writeVariant(const QVariant &value);
+
+    enum ContainerType {
+        Object,
+        Array
+    };
+
+    struct Container
+    {
+        ContainerType type;
+        bool first;
+    };
+
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    QVector<Container> mContainers;
+    QString mError;
+};
+
+} // namespace Json
+
+#endif // JSONSTREAMWRITER_H
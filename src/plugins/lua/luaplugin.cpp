@@ -66,7 +66,7 @@ bool LuaPlugin::write(const Map *map, const QString &fileName)
     writeMap(writer, map);
     writer.writeEndDocument();
 
-    if (file.error() != QFile::NoError) {
+    if (writer.hasError() || file.error() != QFile::NoError) {
         mError = file.errorString();
         return false;
     }
@@ -343,12 +343,17 @@ void LuaPlugin::writeTileLayer(LuaTableWriter &writer,
     case Map::CSV:
         writer.writeKeyAndValue("encoding", "lua");
         writer.writeStartTable("data");
-        for (int y = 0; y < tileLayer->height(); ++y) {
-            if (y > 0)
-                writer.prepareNewLine();
+        {
+            const QVector<unsigned> gids = mGidMapper.layerGids(*tileLayer);
+            const unsigned *gid = gids.constData();
 
-            for (int x = 0; x < tileLayer->width(); ++x)
-                writer.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
+            for (int y = 0; y < tileLayer->height(); ++y) {
+                if (y > 0)
+                    writer.prepareNewLine();
+
+                for (int x = 0; x < tileLayer->width(); ++x)
+                    writer.writeValue(*gid++);
+            }
         }
         writer.writeEndTable();
         break;
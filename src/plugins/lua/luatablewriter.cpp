@@ -24,6 +24,8 @@
 
 namespace Lua {
 
+static const int FlushThreshold = 256 * 1024;
+
 LuaTableWriter::LuaTableWriter(QIODevice *device)
     : m_device(device)
     , m_indent(0)
@@ -33,6 +35,12 @@ LuaTableWriter::LuaTableWriter(QIODevice *device)
     , m_valueWritten(false)
     , m_error(false)
 {
+    m_buffer.reserve(FlushThreshold + 1024);
+}
+
+LuaTableWriter::~LuaTableWriter()
+{
+    flush();
 }
 
 void LuaTableWriter::writeStartDocument()
@@ -44,6 +52,7 @@ void LuaTableWriter::writeEndDocument()
 {
     Q_ASSERT(m_indent == 0);
     write('\n');
+    flush();
 }
 
 void LuaTableWriter::writeStartTable()
@@ -83,6 +92,31 @@ void LuaTableWriter::writeEndTable()
     m_valueWritten = true;
 }
 
+void LuaTableWriter::writeValue(int value)
+{
+    if (value < 0) {
+        prepareNewValue();
+        write('-');
+        writeDigits(0u - unsigned(value)); // also correct for INT_MIN
+        m_newLine = false;
+        m_valueWritten = true;
+    } else {
+        writeValue(unsigned(value));
+    }
+}
+
+/**
+ * Writes an unsigned value. This is the most common value written for tile
+ * layer data, so it is formatted directly into the buffer.
+ */
+void LuaTableWriter::writeValue(unsigned value)
+{
+    prepareNewValue();
+    writeDigits(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
 void LuaTableWriter::writeValue(const QByteArray &value)
 {
     prepareNewValue();
@@ -184,6 +218,9 @@ QString LuaTableWriter::quote(const QString &str)
 
 void LuaTableWriter::prepareNewLine()
 {
+    if (m_buffer.size() >= FlushThreshold)
+        flush();
+
     if (m_valueWritten) {
         write(m_valueSeparator);
         m_valueWritten = false;
@@ -193,6 +230,9 @@ void LuaTableWriter::prepareNewLine()
 
 void LuaTableWriter::prepareNewValue()
 {
+    if (m_buffer.size() >= FlushThreshold)
+        flush();
+
     if (!m_valueWritten) {
         writeNewline();
     } else {
@@ -220,10 +260,33 @@ void LuaTableWriter::writeNewline()
     }
 }
 
-void LuaTableWriter::write(const char *bytes, unsigned length)
+void LuaTableWriter::writeDigits(unsigned value)
+{
+    char digits[10];
+    int count = 0;
+
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    while (count)
+        write(digits[--count]);
+}
+
+/**
+ * Writes the buffered output to the device. Returns whether this succeeded.
+ */
+bool LuaTableWriter::flush()
 {
-    if (m_device->write(bytes, length) != length)
+    if (m_buffer.isEmpty())
+        return !m_error;
+
+    if (m_device->write(m_buffer) != m_buffer.size())
         m_error = true;
+
+    m_buffer.resize(0); // keeps the reserved capacity
+    return !m_error;
 }
 
 } // namespace Lua
@@ -31,11 +31,15 @@ namespace Lua {
 
 /**
  * Makes it easy to produce a well formatted Lua table.
+ *
+ * The output is collected in an internal buffer, which is written to the
+ * device when it grows large and at the end of the document.
  */
 class LuaTableWriter
 {
 public:
     LuaTableWriter(QIODevice *device);
+    ~LuaTableWriter();
 
     void writeStartDocument();
     void writeEndDocument();
@@ -69,6 +73,8 @@ public:
 
     void prepareNewLine();
 
+    bool flush();
+
     bool hasError() const { return m_error; }
 
     static QString quote(const QString &str);
@@ -78,12 +84,14 @@ private:
     void writeIndent();
 
     void writeNewline();
+    void writeDigits(unsigned value);
     void write(const char *bytes, unsigned length);
     void write(const char *bytes);
     void write(const QByteArray &bytes);
     void write(char c);
 
     QIODevice *m_device;
+    QByteArray m_buffer;
     int m_indent;
     char m_valueSeparator;
     bool m_suppressNewlines;
@@ -92,12 +100,6 @@ private:
     bool m_error;
 };
 
-inline void LuaTableWriter::writeValue(int value)
-{ writeUnquotedValue(QByteArray::number(value)); }
-
-inline void LuaTableWriter::writeValue(unsigned value)
-{ writeUnquotedValue(QByteArray::number(value)); }
-
 inline void LuaTableWriter::writeValue(const QString &value)
 { writeUnquotedValue(quote(value).toUtf8()); }
 
@@ -116,14 +118,17 @@ inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, bool value)
 inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, const QString &value)
 { writeKeyAndUnquotedValue(key, quote(value).toUtf8()); }
 
+inline void LuaTableWriter::write(const char *bytes, unsigned length)
+{ m_buffer.append(bytes, int(length)); }
+
 inline void LuaTableWriter::write(const char *bytes)
 { write(bytes, qstrlen(bytes)); }
 
 inline void LuaTableWriter::write(const QByteArray &bytes)
-{ write(bytes.constData(), bytes.length()); }
+{ m_buffer.append(bytes); }
 
 inline void LuaTableWriter::write(char c)
-{ write(&c, 1); }
+{ m_buffer.append(c); }
 
 /**
  * Sets whether newlines should be suppressed. While newlines are suppressed,
@@ -1,5 +1,6 @@
 TEMPLATE = subdirs
-SUBDIRS = csv \
+SUBDIRS = binary \
+          csv \
           defold \
           droidcraft \
           flare \
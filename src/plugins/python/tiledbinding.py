@@ -30,6 +30,7 @@ mod.add_include('"imagelayer.h"')
 mod.add_include('"tilelayer.h"')
 mod.add_include('"objectgroup.h"')
 mod.add_include('"tileset.h"')
+mod.add_include('"gidmapper.h"')
 
 mod.header.writeln('#pragma GCC diagnostic ignored "-Wmissing-field-initializers"')
 
@@ -285,6 +286,170 @@ bool loadTilesetFromFile(Tiled::Tileset *ts, QString file)
 }
 """)
 
+mod.body.writeln("""
+/*
+ * Bulk access to tile layer data, as arrays of native 32-bit global tile IDs.
+ * Going through cellAt and setCell for each tile is very slow for large maps.
+ */
+static bool layerRect(Tiled::TileLayer *layer, int x, int y, int w, int h)
+{
+    if (!layer->map()) {
+        PyErr_SetString(PyExc_RuntimeError, "layer is not part of a map");
+        return false;
+    }
+    // Written to avoid overflowing int with large arguments
+    if (w < 0 || h < 0 || x < 0 || y < 0 ||
+            w > layer->width() - x || h > layer->height() - y) {
+        PyErr_SetString(PyExc_IndexError, "rectangle is outside of the layer");
+        return false;
+    }
+    return true;
+}
+
+static bool copyGids(const void *buffer, Py_ssize_t length,
+                     QVector<unsigned> &gids)
+{
+    const Py_ssize_t expected = gids.size() * Py_ssize_t(sizeof(unsigned));
+    if (length != expected) {
+        PyErr_Format(PyExc_ValueError, "expected %zd bytes of tile data, got %zd",
+                     expected, length);
+        return false;
+    }
+    memcpy(gids.data(), buffer, length);
+    return true;
+}
+
+static bool readGids(PyObject *data, QVector<unsigned> &gids)
+{
+    if (PyObject_CheckBuffer(data)) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) == -1)
+            return false;
+        const bool ok = copyGids(view.buf, view.len, gids);
+        PyBuffer_Release(&view);
+        return ok;
+    }
+#if PY_MAJOR_VERSION < 3
+    // array.array only supports the old buffer interface on Python 2
+    const void *buffer;
+    Py_ssize_t length;
+    if (PyObject_AsReadBuffer(data, &buffer, &length) == -1)
+        return false;
+    return copyGids(buffer, length, gids);
+#else
+    PyErr_SetString(PyExc_TypeError, "expected an object supporting the buffer protocol");
+    return false;
+#endif
+}
+
+PyObject *
+_wrap_PyTiledTileLayer_gids(PyTiledTileLayer *self, PyObject *args, PyObject *kwargs)
+{
+    Tiled::TileLayer *layer = self->obj;
+    int x = 0;
+    int y = 0;
+    int w = layer->width();
+    int h = layer->height();
+    const char *keywords[] = {"x", "y", "w", "h", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, (char *) "|iiii", (char **) keywords, &x, &y, &w, &h)) {
+        return NULL;
+    }
+    if (!layerRect(layer, x, y, w, h))
+        return NULL;
+
+    PyObject *py_retval = PyBytes_FromStringAndSize(NULL, Py_ssize_t(w) * h * sizeof(unsigned));
+    if (!py_retval)
+        return NULL;
+
+    const Tiled::GidMapper gidMapper(layer->map()->tilesets());
+    unsigned *gids = reinterpret_cast<unsigned*>(PyBytes_AS_STRING(py_retval));
+    for (int j = y; j < y + h; ++j)
+        for (int i = x; i < x + w; ++i)
+            *gids++ = gidMapper.cellToGid(layer->cellAt(i, j));
+
+    return py_retval;
+}
+
+PyObject *
+_wrap_PyTiledTileLayer_setGids(PyTiledTileLayer *self, PyObject *args, PyObject *kwargs)
+{
+    Tiled::TileLayer *layer = self->obj;
+    PyObject *data;
+    int x = 0;
+    int y = 0;
+    int w = layer->width();
+    int h = layer->height();
+    const char *keywords[] = {"data", "x", "y", "w", "h", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, (char *) "O|iiii", (char **) keywords, &data, &x, &y, &w, &h)) {
+        return NULL;
+    }
+    if (!layerRect(layer, x, y, w, h))
+        return NULL;
+
+    QVector<unsigned> gids(w * h);
+    if (!readGids(data, gids))
+        return NULL;
+
+    // Decode all cells first, so the layer is left untouched on error
+    const Tiled::GidMapper gidMapper(layer->map()->tilesets());
+    QVector<Tiled::Cell> cells(gids.size());
+    for (int i = 0; i < gids.size(); ++i) {
+        bool ok;
+        cells[i] = gidMapper.gidToCell(gids.at(i), ok);
+        if (!ok) {
+            PyErr_Format(PyExc_ValueError, "invalid global tile ID %u", gids.at(i));
+            return NULL;
+        }
+    }
+
+    const Tiled::Cell *cell = cells.constData();
+    for (int j = y; j < y + h; ++j)
+        for (int i = x; i < x + w; ++i)
+            layer->setCell(i, j, *cell++);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+/*
+ * Creates the given number of tiles without an image, returning the ID of
+ * the first new tile.
+ */
+PyObject *
+_wrap_PyTiledTileset_createTiles(PyTiledTileset *self, PyObject *args, PyObject *kwargs)
+{
+    int count;
+    const char *keywords[] = {"count", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, (char *) "i", (char **) keywords, &count)) {
+        return NULL;
+    }
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must not be negative");
+        return NULL;
+    }
+
+    Tiled::Tileset *tileset = self->obj;
+    const int firstId = tileset->nextTileId();
+
+    QList<Tiled::Tile*> tiles;
+    tiles.reserve(count);
+    for (int i = 0; i < count; ++i)
+        tiles.append(new Tiled::Tile(tileset->takeNextTileId(), tileset));
+    tileset->addTiles(tiles);
+
+    return Py_BuildValue((char *) "i", firstId);
+}
+""")
+
+cls_tilelayer.add_custom_method_wrapper('gids', '_wrap_PyTiledTileLayer_gids')
+cls_tilelayer.add_custom_method_wrapper('setGids',
+    '_wrap_PyTiledTileLayer_setGids')
+cls_tileset.add_custom_method_wrapper('createTiles',
+    '_wrap_PyTiledTileset_createTiles')
+
 """
  C++ class PythonScript is seen as Tiled.Plugin from Python script
  (naming describes the opposite side from either perspective)
@@ -20,8 +20,8 @@
 
 #include "tmwplugin.h"
 
+#include "layerexport.h"
 #include "map.h"
-#include "tile.h"
 #include "tilelayer.h"
 
 #include <QDataStream>
@@ -72,12 +72,13 @@ bool TmwPlugin::write(const Tiled::Map *map, const QString &fileName)
     stream << (qint16) width;
     stream << (qint16) height;
 
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            Tile *tile = collisionLayer->cellAt(x, y).tile;
-            stream << (qint8) (tile && tile->id() > 0);
-        }
-    }
+    // Any tile other than the first one is a collision
+    const QVector<int> tileIds = layerTileIds(*collisionLayer);
+    QByteArray collisions(tileIds.size(), Qt::Uninitialized);
+    for (int i = 0; i < tileIds.size(); ++i)
+        collisions[i] = tileIds.at(i) > 0;
+
+    stream.writeRawData(collisions.constData(), collisions.size());
 
     if (!file.commit()) {
         mError = file.errorString();
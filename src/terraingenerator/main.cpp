@@ -30,8 +30,13 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QPainter>
+#include <QSet>
 #include <QStringList>
+#include <QtConcurrentMap>
+
+#include <algorithm>
 
 using namespace Tiled;
 
@@ -214,99 +219,122 @@ static unsigned short terrainId(const QString &name, const Tileset &tileset)
     return 0xFF;
 }
 
-static QString nameOf(Terrain *terrain)
-{
-    return terrain ? terrain->name() : QString();
-}
+static const int NoTerrain = -1;
 
-struct TileTerrainNames
+/**
+ * Assigns an integer ID to each terrain name, so that terrain combinations
+ * can be stored and compared without comparing strings.
+ */
+class TerrainIds
 {
-    TileTerrainNames() {}
+public:
+    int id(const QString &name)
+    {
+        if (name.isEmpty())
+            return NoTerrain;
 
-    explicit TileTerrainNames(Tile *tile)
-        : topLeft(nameOf(tile->terrainAtCorner(0)))
-        , topRight(nameOf(tile->terrainAtCorner(1)))
-        , bottomLeft(nameOf(tile->terrainAtCorner(2)))
-        , bottomRight(nameOf(tile->terrainAtCorner(3)))
+        auto it = mIds.find(name);
+        if (it == mIds.end()) {
+            it = mIds.insert(name, mNames.size());
+            mNames.append(name);
+        }
+        return it.value();
+    }
+
+    int id(Terrain *terrain)
     {
+        return terrain ? id(terrain->name()) : NoTerrain;
     }
 
-    TileTerrainNames(QString topLeft,
-                     QString topRight,
-                     QString bottomLeft,
-                     QString bottomRight)
-        : topLeft(topLeft)
-        , topRight(topRight)
-        , bottomLeft(bottomLeft)
-        , bottomRight(bottomRight)
-    {}
+    QString name(int id) const
+    {
+        return id == NoTerrain ? QString() : mNames.at(id);
+    }
+
+    int count() const { return mNames.size(); }
 
-    unsigned toTerrain(const Tileset &tileset) const
+private:
+    QHash<QString, int> mIds;
+    QStringList mNames;
+};
+
+/**
+ * The terrain IDs at the four corners of a tile.
+ */
+struct TileTerrains
+{
+    TileTerrains()
     {
-        return makeTerrain(terrainId(topLeft, tileset),
-                           terrainId(topRight, tileset),
-                           terrainId(bottomLeft, tileset),
-                           terrainId(bottomRight, tileset));
+        std::fill(corners, corners + 4, NoTerrain);
     }
 
-    TileTerrainNames filter(const QString &terrainName) const
+    TileTerrains(Tile *tile, TerrainIds &terrainIds)
     {
-        return TileTerrainNames(topLeft == terrainName ? topLeft : QString(),
-                                topRight == terrainName ? topRight : QString(),
-                                bottomLeft == terrainName ? bottomLeft : QString(),
-                                bottomRight == terrainName ? bottomRight : QString());
+        for (int i = 0; i < 4; ++i)
+            corners[i] = terrainIds.id(tile->terrainAtCorner(i));
     }
 
-    QStringList terrainList() const
+    TileTerrains(int topLeft, int topRight, int bottomLeft, int bottomRight)
     {
-        QStringList list;
-        list << topLeft;
-        if (!list.contains(topRight))
-            list << topRight;
-        if (!list.contains(bottomLeft))
-            list << bottomLeft;
-        if (!list.contains(bottomRight))
-            list << bottomRight;
-        return list;
+        corners[0] = topLeft;
+        corners[1] = topRight;
+        corners[2] = bottomLeft;
+        corners[3] = bottomRight;
     }
 
-    bool operator < (const TileTerrainNames &other) const
+    TileTerrains filter(int terrain) const
     {
-        if (topLeft != other.topLeft)
-            return topLeft < other.topLeft;
-        if (topRight != other.topRight)
-            return topRight < other.topRight;
-        if (bottomLeft != other.bottomLeft)
-            return bottomLeft < other.bottomLeft;
-
-        return bottomRight < other.bottomRight;
+        TileTerrains filtered;
+        for (int i = 0; i < 4; ++i)
+            if (corners[i] == terrain)
+                filtered.corners[i] = terrain;
+        return filtered;
     }
 
-    QString topLeft;
-    QString topRight;
-    QString bottomLeft;
-    QString bottomRight;
-};
+    QVector<int> terrainList() const
+    {
+        QVector<int> list;
+        for (int i = 0; i < 4; ++i)
+            if (!list.contains(corners[i]))
+                list.append(corners[i]);
+        return list;
+    }
 
-struct TerrainLessThan
-{
-    bool operator () (const QString &terrainA, const QString &terrainB) const
+    QString toString(const TerrainIds &terrainIds) const
     {
-        return terrainPriority[terrainA] < terrainPriority[terrainB];
+        return QLatin1Char('[') + terrainIds.name(corners[0]) +
+                QLatin1String(", ") + terrainIds.name(corners[1]) +
+                QLatin1String(", ") + terrainIds.name(corners[2]) +
+                QLatin1String(", ") + terrainIds.name(corners[3]) +
+                QLatin1Char(']');
     }
 
-    QMap<QString, int> terrainPriority;
+    bool operator == (const TileTerrains &other) const
+    {
+        return std::equal(corners, corners + 4, other.corners);
+    }
+
+    int corners[4];
 };
 
-static QDebug operator<<(QDebug dbg, const TileTerrainNames &t)
+static uint qHash(const TileTerrains &terrains, uint seed = 0)
 {
-    dbg.nospace() << '[' << t.topLeft
-                  << ", " << t.topRight
-                  << ", " << t.bottomLeft
-                  << ", " << t.bottomRight << ']';
-    return dbg.space();
+    quint64 key = 0;
+    for (int i = 0; i < 4; ++i)
+        key = key << 16 | quint16(terrains.corners[i] + 1);
+    return qHash(key, seed);
 }
 
+/**
+ * A tile to generate, by drawing the images of the given tiles on top of
+ * each other.
+ */
+struct Composition
+{
+    QVector<Tile*> layers;
+    QImage image;
+};
+
 static bool isEmpty(const QImage &image)
 {
     if (image.format() == QImage::Format_RGB32)
@@ -325,6 +353,41 @@ static bool isEmpty(const QImage &image)
     return true;
 }
 
+/**
+ * Makes identical images share their data. Returns the number of duplicate
+ * images found.
+ */
+static int shareIdenticalImages(QVector<Composition> &compositions)
+{
+    QMultiHash<uint, int> indexesByContent;
+    int duplicates = 0;
+
+    for (int i = 0; i < compositions.size(); ++i) {
+        QImage &image = compositions[i].image;
+        const QByteArray bits =
+                QByteArray::fromRawData(reinterpret_cast<const char*>(image.constBits()),
+                                        image.byteCount());
+        const uint hash = qHash(bits);
+
+        bool found = false;
+        auto it = indexesByContent.constFind(hash);
+        for (; it != indexesByContent.constEnd() && it.key() == hash; ++it) {
+            const QImage &other = compositions.at(it.value()).image;
+            if (other == image) {
+                image = other;
+                found = true;
+                ++duplicates;
+                break;
+            }
+        }
+
+        if (!found)
+            indexesByContent.insert(hash, i);
+    }
+
+    return duplicates;
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -417,13 +480,19 @@ int main(int argc, char *argv[])
         targetTileset = Tileset::create(name, tileWidth, tileHeight);
     }
 
+    TerrainIds terrainIds;
+
     // Set up a mapping from terrain to tile, for quick lookup
-    QMap<TileTerrainNames, Tile*> terrainToTile;
-    foreach (const SharedTileset &tileset, sources)
-        foreach (Tile *tile, tileset->tiles())
-            if (tile->terrain() != 0xFFFFFFFF)
-                if (!terrainToTile.contains(TileTerrainNames(tile))) // TODO: Optimize
-                    terrainToTile.insert(TileTerrainNames(tile), tile);
+    QHash<TileTerrains, Tile*> terrainToTile;
+    foreach (const SharedTileset &tileset, sources) {
+        foreach (Tile *tile, tileset->tiles()) {
+            if (tile->terrain() != 0xFFFFFFFF) {
+                const TileTerrains terrains(tile, terrainIds);
+                if (!terrainToTile.contains(terrains))
+                    terrainToTile.insert(terrains, tile);
+            }
+        }
+    }
 
     // Set up the list of all terrains, mapped by name.
     QMap<QString, Terrain*> terrains;
@@ -453,37 +522,55 @@ int main(int argc, char *argv[])
     }
 
     // Setup terrain priorities.
-    TerrainLessThan lessThan;
+    QMap<QString, int> terrainPriority;
     int priority = 0;
     foreach (const QString &terrainName, options.terrainPriority) {
-        lessThan.terrainPriority.insert(terrainName, priority);
+        terrainPriority.insert(terrainName, priority);
         ++priority;
     }
 
     qDebug() << "Terrains found:" << terrains.keys();
 
     // Check if all terrains from priority list were found and loaded.
-    foreach (const QString &terrainName, lessThan.terrainPriority.keys())
+    foreach (const QString &terrainName, terrainPriority.keys())
         if (!terrains.contains(terrainName))
             qWarning() << "Terrain" << terrainName << "from priority list not found.";
 
     // Add terrain names not specified from command line.
     foreach (const QString &terrainName, terrains.keys()) {
-        if (!lessThan.terrainPriority.contains(terrainName)) {
+        if (!terrainPriority.contains(terrainName)) {
             qWarning() << "No priority set for" << terrainName;
-            lessThan.terrainPriority.insert(terrainName, priority);
+            terrainPriority.insert(terrainName, priority);
             ++priority;
         }
+        terrainIds.id(terrainName);
     }
 
+    // Images of the tiles added to the target tileset, by tile ID. These are
+    // only converted to pixmaps when they need to be embedded.
+    QMap<int, QImage> newTileImages;
+
+    auto addTile = [&](const QImage &image) -> Tile* {
+        Tile *tile = targetTileset->findOrCreateTile(targetTileset->nextTileId());
+        newTileImages.insert(tile->id(), image);
+        return tile;
+    };
+
+    // Source tile images, converted once since they may be used many times
+    QHash<Tile*, QImage> tileImages;
+
+    auto imageOf = [&](Tile *tile) -> QImage {
+        auto it = tileImages.find(tile);
+        if (it == tileImages.end())
+            it = tileImages.insert(tile, tile->image().toImage());
+        return it.value();
+    };
+
     // Add terrains that are not defined in the target tileset yet
     // TODO: This step should be more configurable
     foreach (Terrain *terrain, terrains) {
         if (!hasTerrain(*targetTileset, terrain->name())) {
-            Tile *terrainTile = terrain->imageTile();
-            QPixmap terrainImage = terrainTile->image();
-
-            Tile *newTerrainTile = targetTileset->addTile(terrainImage);
+            Tile *newTerrainTile = addTile(imageOf(terrain->imageTile()));
 
             Terrain *newTerrain =  targetTileset->addTerrain(terrain->name(),
                                                              newTerrainTile->id());
@@ -491,29 +578,50 @@ int main(int argc, char *argv[])
             // WARNING: This assumes the terrain tile has this terrain on all
             // its corners.
             newTerrainTile->setTerrain(makeTerrain(newTerrain->id()));
-            terrainToTile.insert(TileTerrainNames(newTerrainTile),
+            terrainToTile.insert(TileTerrains(newTerrainTile, terrainIds),
                                  newTerrainTile);
         }
     }
 
-    // Prepare a list of terrain combinations.
-    QVector<TileTerrainNames> process;
+    // Look up the priorities and target terrain IDs by terrain ID
+    QVector<int> priorities(terrainIds.count());
+    QVector<unsigned short> targetTerrainIds(terrainIds.count());
+    for (int id = 0; id < terrainIds.count(); ++id) {
+        const QString name = terrainIds.name(id);
+        priorities[id] = terrainPriority.value(name);
+        targetTerrainIds[id] = terrainId(name, *targetTileset);
+    }
+
+    auto toTerrain = [&](const TileTerrains &tileTerrains) -> unsigned {
+        unsigned short ids[4];
+        for (int i = 0; i < 4; ++i) {
+            const int id = tileTerrains.corners[i];
+            ids[i] = id == NoTerrain ? 0xFF : targetTerrainIds.at(id);
+        }
+        return makeTerrain(ids[0], ids[1], ids[2], ids[3]);
+    };
+
+    // Prepare a list of terrain combinations, skipping the ones that are
+    // part of several combine sets.
+    QVector<TileTerrains> process;
+    QSet<TileTerrains> queued;
     foreach (const QStringList& combine, options.combineList) {
-        QList<Terrain*> terrainList;
+        QVector<int> terrainList;
         // get the terrains to combine
-        foreach (const QString& terrainName, combine) {
-            terrainList.append(terrains[terrainName]);
-        }
+        foreach (const QString& terrainName, combine)
+            terrainList.append(terrainIds.id(terrainName));
 
         // Construct a vector with all terrain combinations to process
-        foreach (Terrain *topLeft, terrainList) {
-            foreach (Terrain *topRight, terrainList) {
-                foreach (Terrain *bottomLeft, terrainList) {
-                    foreach (Terrain *bottomRight, terrainList) {
-                        process.append(TileTerrainNames(topLeft->name(),
-                                                        topRight->name(),
-                                                        bottomLeft->name(),
-                                                        bottomRight->name()));
+        for (int topLeft : terrainList) {
+            for (int topRight : terrainList) {
+                for (int bottomLeft : terrainList) {
+                    for (int bottomRight : terrainList) {
+                        const TileTerrains combination(topLeft, topRight,
+                                                       bottomLeft, bottomRight);
+                        if (!queued.contains(combination)) {
+                            queued.insert(combination);
+                            process.append(combination);
+                        }
                     }
                 }
             }
@@ -521,63 +629,111 @@ int main(int argc, char *argv[])
     }
 
     // Go through each combination of terrains and add the tile to the target
-    // tileset if it's not in there yet.
-    foreach (TileTerrainNames terrainNames, process) {
-        Tile *tile = terrainToTile.value(terrainNames);
+    // tileset if it's not in there yet. Tiles that need to be generated are
+    // only composed afterwards, since they don't depend on each other.
+    QVector<Composition> compositions;
+    QHash<QByteArray, int> compositionIndexes;
+    QVector<QPair<int, int>> generatedTiles;    // tile ID, composition index
+
+    foreach (const TileTerrains &tileTerrains, process) {
+        Tile *tile = terrainToTile.value(tileTerrains);
 
         if (tile && tile->tileset() == targetTileset)
             continue;
 
-        QPixmap image;
+        Tile *newTile;
 
         if (!tile) {
-            qWarning() << "Generating" << terrainNames;
+            qWarning() << "Generating" << qPrintable(tileTerrains.toString(terrainIds));
 
-            // Start a new image
-            QImage tileImage = QImage(targetTileset->tileWidth(),
-                                      targetTileset->tileHeight(),
-                                      QImage::Format_ARGB32);
-            tileImage.fill(Qt::transparent);
-            QPainter painter(&tileImage);
-
-            QStringList terrainList = terrainNames.terrainList();
-            qSort(terrainList.begin(), terrainList.end(), lessThan);
+            QVector<int> terrainList = tileTerrains.terrainList();
+            std::sort(terrainList.begin(), terrainList.end(), [&](int a, int b) {
+                return priorities.at(a) < priorities.at(b);
+            });
 
             // Draw the lowest terrain to avoid pixel gaps
-            QString baseTerrain = terrainList.first();
-            QPixmap baseImage = terrains[baseTerrain]->imageTile()->image();
-            painter.drawPixmap(0, 0, baseImage);
+            QVector<Tile*> layers;
+            layers.append(terrains[terrainIds.name(terrainList.first())]->imageTile());
 
-            foreach (const QString &terrainName, terrainList) {
-                TileTerrainNames filtered = terrainNames.filter(terrainName);
+            for (int terrain : terrainList) {
+                const TileTerrains filtered = tileTerrains.filter(terrain);
                 Tile *tile = terrainToTile.value(filtered);
                 if (!tile) {
-                    qWarning() << "Missing" << filtered;
+                    qWarning() << "Missing" << qPrintable(filtered.toString(terrainIds));
                     continue;
                 }
 
-                painter.drawPixmap(0, 0, tile->image());
+                layers.append(tile);
             }
 
-            image = QPixmap::fromImage(tileImage);
+            // Combinations drawn from the same tiles only need to be composed
+            // once.
+            const QByteArray key(reinterpret_cast<const char*>(layers.constData()),
+                                 layers.size() * int(sizeof(Tile*)));
+
+            int index = compositionIndexes.value(key, -1);
+            if (index == -1) {
+                index = compositions.size();
+                compositionIndexes.insert(key, index);
+
+                for (Tile *layer : layers)
+                    imageOf(layer);
+
+                Composition composition;
+                composition.layers = layers;
+                compositions.append(composition);
+            }
+
+            newTile = addTile(QImage());
+            generatedTiles.append(qMakePair(newTile->id(), index));
         } else {
-            qWarning() << "Copying" << terrainNames << "from"
-                       << QFileInfo(tile->tileset()->fileName()).fileName();
+            qWarning() << "Copying" << qPrintable(tileTerrains.toString(terrainIds))
+                       << "from" << QFileInfo(tile->tileset()->fileName()).fileName();
 
-            image = tile->image();
+            newTile = addTile(imageOf(tile));
         }
 
-        Tile *newTile = targetTileset->addTile(image);
-        newTile->setTerrain(terrainNames.toTerrain(*targetTileset));
-        terrainToTile.insert(terrainNames, newTile);
+        newTile->setTerrain(toTerrain(tileTerrains));
+        terrainToTile.insert(tileTerrains, newTile);
     }
 
+    // Compose the generated tiles in parallel. QPixmap can't be used outside
+    // of the GUI thread, so all source images were converted up front.
+    const QSize tileSize = targetTileset->tileSize();
+    const QHash<Tile*, QImage> &sourceImages = tileImages;
+
+    QtConcurrent::blockingMap(compositions, [&](Composition &composition) {
+        QImage image(tileSize, QImage::Format_ARGB32);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        for (Tile *tile : composition.layers)
+            painter.drawImage(0, 0, *sourceImages.constFind(tile));
+        painter.end();
+
+        composition.image = image;
+    });
+
+    const int duplicates = shareIdenticalImages(compositions);
+    qWarning() << "Generated" << generatedTiles.size() << "tiles from"
+               << compositions.size() - duplicates << "distinct images";
+
+    for (const auto &generatedTile : generatedTiles)
+        newTileImages.insert(generatedTile.first,
+                             compositions.at(generatedTile.second).image);
+
     if (targetTileset->tileCount() == 0)
         qFatal("Target tileset is empty");
 
     if (options.embedImage) {
         // Make sure there is no source name, this way the image will be saved in the TSX file.
         targetTileset->setImageSource(QString());
+
+        QMapIterator<int, QImage> it(newTileImages);
+        while (it.hasNext()) {
+            it.next();
+            targetTileset->findTile(it.key())->setImage(QPixmap::fromImage(it.value()));
+        }
     } else {
         // Save the target tileset image as separate file.
         int columns = qMin(16, targetTileset->tileCount());
@@ -597,14 +753,22 @@ int main(int argc, char *argv[])
         foreach (Tile *tile, targetTileset->tiles()) {
             int x = (tile->id() % 16) * targetTileset->tileWidth();
             int y = (tile->id() / 16) * targetTileset->tileHeight();
-            painter.drawPixmap(x, y, tile->image());
+
+            auto it = newTileImages.constFind(tile->id());
+            if (it != newTileImages.constEnd())
+                painter.drawImage(x, y, it.value());
+            else
+                painter.drawPixmap(x, y, tile->image());
         }
 
+        painter.end();
+
         QString imageFileName = QFileInfo(options.target).completeBaseName();
         imageFileName += ".png";
         image.save(imageFileName);
 
         targetTileset->setImageSource(imageFileName);
+        targetTileset->setColumnCount(columns);
     }
 
     // Save the target tileset
@@ -6,6 +6,7 @@ TARGET = terraingenerator
 target.path = $${PREFIX}/bin
 INSTALLS += target
 CONFIG += console
+QT += concurrent
 TEMPLATE = app
 win32 {
     DESTDIR = ../..
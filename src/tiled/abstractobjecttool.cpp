@@ -112,12 +112,8 @@ ObjectGroup *AbstractObjectTool::currentObjectGroup() const
 
 MapObjectItem *AbstractObjectTool::topMostObjectItemAt(QPointF pos) const
 {
-    const QList<QGraphicsItem *> &items = mMapScene->items(pos);
-    for (QGraphicsItem *item : items) {
-        if (MapObjectItem *objectItem = qgraphicsitem_cast<MapObjectItem*>(item))
-            return objectItem;
-    }
-    return nullptr;
+    const QList<MapObjectItem*> items = mMapScene->objectItemsAt(pos);
+    return items.isEmpty() ? nullptr : items.first();
 }
 
 void AbstractObjectTool::duplicateObjects()
@@ -50,10 +50,9 @@ using namespace Tiled::Internal;
  * are put directly below each of these functions.
  */
 
-AutoMapper::AutoMapper(MapDocument *workingDocument, Map *rules,
-                       const QString &rulePath)
-    : mMapDocument(workingDocument)
-    , mMapWork(workingDocument ? workingDocument->map() : nullptr)
+AutoMapper::AutoMapper(Map *rules, const QString &rulePath)
+    : mMapDocument(nullptr)
+    , mMapWork(nullptr)
     , mMapRules(rules)
     , mLayerInputRegions(nullptr)
     , mLayerOutputRegions(nullptr)
@@ -226,8 +225,9 @@ bool AutoMapper::setupRuleMapTileLayers()
             else
                 mTouchedObjectGroups.insert(name);
 
-            Layer::TypeFlag type = layer->layerType();
-            int layerIndex = mMapWork->indexOfLayer(name, type);
+            // The index in the working map is looked up in
+            // setupCorrectIndexes, since it depends on the working map.
+            const int layerIndex = -1;
 
             bool found = false;
             foreach (RuleOutput *translationTable, mLayerList) {
@@ -322,11 +322,14 @@ bool AutoMapper::setupRuleList()
     return true;
 }
 
-bool AutoMapper::prepareAutoMap()
+bool AutoMapper::prepareAutoMap(MapDocument *workingDocument)
 {
     mError.clear();
     mWarning.clear();
 
+    mMapDocument = workingDocument;
+    mMapWork = workingDocument->map();
+
     if (!setupMissingLayers())
         return false;
 
@@ -853,6 +856,9 @@ void AutoMapper::cleanAll()
 {
     cleanTilesets();
     cleanTileLayers();
+
+    mMapDocument = nullptr;
+    mMapWork = nullptr;
 }
 
 void AutoMapper::cleanTilesets()
@@ -85,14 +85,13 @@ public:
     /**
      * Constructs an AutoMapper.
      * All data structures, which only rely on the rules map are setup
-     * here. 
+     * here. Since these do not depend on the map being worked on, a single
+     * AutoMapper can be shared by all map documents using the same rules.
      * 
-     * @param workingDocument: the map to work on.
      * @param rules: The rule map which should be used for automapping
      * @param rulePath: The filepath to the rule map.
      */
-    AutoMapper(MapDocument *workingDocument, Map *rules, 
-               const QString &rulePath);
+    AutoMapper(Map *rules, const QString &rulePath);
     ~AutoMapper();
 
     /**
@@ -113,8 +112,10 @@ public:
      * It sets up some data structures which change rapidly, so it is quite
      * painful to keep these data structures up to date all time. (indices of
      * layers of the working map)
+     *
+     * @param workingDocument: the map to work on, until cleanAll is called.
      */
-    bool prepareAutoMap();
+    bool prepareAutoMap(MapDocument *workingDocument);
 
     /**
      * Here is done all the automapping.
@@ -123,7 +124,8 @@ public:
 
     /**
      * This cleans all data structures, which are setup via prepareAutoMap,
-     * so the auto mapper becomes ready for its next automatic mapping.
+     * so the auto mapper becomes ready for its next automatic mapping,
+     * possibly on another map document.
      */
     void cleanAll();
 
@@ -255,7 +257,7 @@ private:
     void cleanTileLayers();
 
     /**
-     * where to work in
+     * where to work in, only set between prepareAutoMap and cleanAll
      */
     MapDocument *mMapDocument;
 
@@ -39,7 +39,7 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
     int index = 0;
     while (index < autoMapper.size()) {
         AutoMapper *a = autoMapper.at(index);
-        if (a->prepareAutoMap()) {
+        if (a->prepareAutoMap(mapDocument)) {
             touchedLayers |= a->getTouchedTileLayers();
             index++;
         } else {
@@ -21,15 +21,13 @@
 #include "automappingmanager.h"
 
 #include "automapperwrapper.h"
+#include "automappingrulecache.h"
 #include "map.h"
 #include "mapdocument.h"
 #include "tilelayer.h"
-#include "tilesetmanager.h"
-#include "tmxmapformat.h"
 #include "preferences.h"
 
 #include <QFileInfo>
-#include <QTextStream>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -39,6 +37,8 @@ AutomappingManager::AutomappingManager(QObject *parent)
     , mMapDocument(nullptr)
     , mLoaded(false)
 {
+    connect(AutomappingRuleCache::instance(), &AutomappingRuleCache::rulesChanged,
+            this, &AutomappingManager::rulesChanged);
 }
 
 AutomappingManager::~AutomappingManager()
@@ -75,6 +75,8 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
     const bool automatic = touchedLayer != nullptr;
 
     if (!mLoaded) {
+        cleanUp();
+
         const QString mapPath = QFileInfo(mMapDocument->fileName()).path();
         const QString rulesFileName = mapPath + QLatin1String("/rules.txt");
         if (loadFile(rulesFileName)) {
@@ -86,13 +88,9 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
     }
 
     QVector<AutoMapper*> passedAutoMappers;
-    if (touchedLayer) {
-        foreach (AutoMapper *a, mAutoMappers) {
-            if (a->ruleLayerNameUsed(touchedLayer->name()))
-                passedAutoMappers.append(a);
-        }
-    } else {
-        passedAutoMappers = mAutoMappers;
+    for (const QSharedPointer<AutoMapper> &a : mAutoMappers) {
+        if (!touchedLayer || a->ruleLayerNameUsed(touchedLayer->name()))
+            passedAutoMappers.append(a.data());
     }
     if (!passedAutoMappers.isEmpty()) {
         // use a copy of the region, so each automapper can manipulate it and the
@@ -105,7 +103,7 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
         undoStack->push(aw);
         undoStack->endMacro();
     }
-    foreach (AutoMapper *automapper, mAutoMappers) {
+    for (AutoMapper *automapper : passedAutoMappers) {
         mWarning += automapper->warningString();
         mError += automapper->errorString();
     }
@@ -120,64 +118,45 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
 bool AutomappingManager::loadFile(const QString &filePath)
 {
     bool ret = true;
-    const QString absPath = QFileInfo(filePath).path();
-    QFile rulesFile(filePath);
+    AutomappingRuleCache *ruleCache = AutomappingRuleCache::instance();
 
-    if (!rulesFile.exists()) {
+    if (!QFileInfo(filePath).exists()) {
         mError += tr("No rules file found at:\n%1").arg(filePath)
                   + QLatin1Char('\n');
         return false;
     }
-    if (!rulesFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+
+    QStringList rulePaths;
+    if (!ruleCache->rulesFileEntries(filePath, rulePaths)) {
         mError += tr("Error opening rules file:\n%1").arg(filePath)
                   + QLatin1Char('\n');
         return false;
     }
 
-    QTextStream in(&rulesFile);
-    QString line = in.readLine();
-
-    for (; !line.isNull(); line = in.readLine()) {
-        QString rulePath = line.trimmed();
-        if (rulePath.isEmpty()
-                || rulePath.startsWith(QLatin1Char('#'))
-                || rulePath.startsWith(QLatin1String("//")))
-            continue;
-
-        if (QFileInfo(rulePath).isRelative())
-            rulePath = absPath + QLatin1Char('/') + rulePath;
-
+    for (const QString &rulePath : rulePaths) {
         if (!QFileInfo(rulePath).exists()) {
             mError += tr("File not found:\n%1").arg(rulePath) + QLatin1Char('\n');
             ret = false;
             continue;
         }
         if (rulePath.endsWith(QLatin1String(".tmx"), Qt::CaseInsensitive)) {
-            TmxMapFormat tmxFormat;
-
-            Map *rules = tmxFormat.read(rulePath);
+            QString readError;
+            QSharedPointer<AutoMapper> autoMapper =
+                    ruleCache->autoMapper(rulePath, readError);
 
-            if (!rules) {
+            if (!autoMapper) {
                 mError += tr("Opening rules map failed:\n%1").arg(
-                        tmxFormat.errorString()) + QLatin1Char('\n');
+                        readError) + QLatin1Char('\n');
                 ret = false;
                 continue;
             }
 
-            TilesetManager *tilesetManager = TilesetManager::instance();
-            tilesetManager->addReferences(rules->tilesets());
-
-            AutoMapper *autoMapper;
-            autoMapper = new AutoMapper(mMapDocument, rules, rulePath);
-
             mWarning += autoMapper->warningString();
-            const QString error = autoMapper->errorString(); 
-            if (error.isEmpty()) {
+            const QString error = autoMapper->errorString();
+            if (error.isEmpty())
                 mAutoMappers.append(autoMapper);
-            } else {
+            else
                 mError += error;
-                delete autoMapper;
-            }
         }
         if (rulePath.endsWith(QLatin1String(".txt"), Qt::CaseInsensitive)) {
             if (!loadFile(rulePath))
@@ -203,8 +182,13 @@ void AutomappingManager::setMapDocument(MapDocument *mapDocument)
     mLoaded = false;
 }
 
+void AutomappingManager::rulesChanged()
+{
+    // Look up the rules again on the next automapping operation
+    mLoaded = false;
+}
+
 void AutomappingManager::cleanUp()
 {
-    qDeleteAll(mAutoMappers);
     mAutoMappers.clear();
 }
@@ -23,6 +23,7 @@
 
 #include <QObject>
 #include <QRegion>
+#include <QSharedPointer>
 #include <QString>
 #include <QVector>
 
@@ -76,6 +77,7 @@ public slots:
 
 private slots:
     void autoMap(const QRegion &where, Layer *touchedLayer);
+    void rulesChanged();
 
 private:
     Q_DISABLE_COPY(AutomappingManager)
@@ -83,7 +85,8 @@ private:
     /**
      * This function parses a rules file.
      * For each path which is a rule, (file extension is tmx) an AutoMapper
-     * object is setup.
+     * object is looked up in the AutomappingRuleCache, which sets it up
+     * when necessary.
      *
      * If a file extension is txt, this file will be opened and searched for
      * rules again.
@@ -102,7 +105,7 @@ private:
     void autoMapInternal(const QRegion &where, Layer *touchedLayer);
 
     /**
-     * deletes all its data structures
+     * releases all its data structures
      */
     void cleanUp();
 
@@ -112,10 +115,11 @@ private:
     MapDocument *mMapDocument;
 
     /**
-     * For each new file of rules a new AutoMapper is setup. In this vector we
-     * can store all of the AutoMappers in order.
+     * For each file of rules an AutoMapper is setup. In this vector we
+     * can store all of the AutoMappers in order. They are shared with other
+     * documents using the same rules.
      */
-    QVector<AutoMapper*> mAutoMappers;
+    QVector<QSharedPointer<AutoMapper>> mAutoMappers;
 
     /**
      * This tells you if the rules for the current map document were already
@@ -0,0 +1,200 @@
+/*
+ * automappingrulecache.cpp
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "automappingrulecache.h"
+
+#include "automapper.h"
+#include "filesystemwatcher.h"
+#include "map.h"
+#include "tilesetmanager.h"
+#include "tmxmapformat.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+AutomappingRuleCache *AutomappingRuleCache::mInstance;
+
+AutomappingRuleCache::AutomappingRuleCache()
+    : mWatcher(new FileSystemWatcher(this))
+{
+    connect(mWatcher, SIGNAL(fileChanged(QString)),
+            this, SLOT(fileChanged(QString)));
+
+    mChangedFilesTimer.setInterval(500);
+    mChangedFilesTimer.setSingleShot(true);
+
+    connect(&mChangedFilesTimer, &QTimer::timeout,
+            this, &AutomappingRuleCache::fileChangedTimeout);
+}
+
+AutomappingRuleCache::~AutomappingRuleCache()
+{
+}
+
+AutomappingRuleCache *AutomappingRuleCache::instance()
+{
+    if (!mInstance)
+        mInstance = new AutomappingRuleCache;
+
+    return mInstance;
+}
+
+void AutomappingRuleCache::deleteInstance()
+{
+    delete mInstance;
+    mInstance = nullptr;
+}
+
+bool AutomappingRuleCache::rulesFileEntries(const QString &filePath,
+                                            QStringList &entries)
+{
+    const QDateTime lastModified = QFileInfo(filePath).lastModified();
+
+    auto it = mRulesFiles.constFind(filePath);
+    if (it != mRulesFiles.constEnd()) {
+        if (it.value().lastModified == lastModified) {
+            entries = it.value().entries;
+            return true;
+        }
+
+        // Changed without us being notified (yet)
+        invalidate(filePath);
+    }
+
+    QFile rulesFile(filePath);
+    if (!rulesFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    const QString absPath = QFileInfo(filePath).path();
+
+    RulesFile cached;
+    cached.lastModified = lastModified;
+
+    QTextStream in(&rulesFile);
+    QString line = in.readLine();
+
+    for (; !line.isNull(); line = in.readLine()) {
+        QString rulePath = line.trimmed();
+        if (rulePath.isEmpty()
+                || rulePath.startsWith(QLatin1Char('#'))
+                || rulePath.startsWith(QLatin1String("//")))
+            continue;
+
+        if (QFileInfo(rulePath).isRelative())
+            rulePath = absPath + QLatin1Char('/') + rulePath;
+
+        cached.entries.append(rulePath);
+    }
+
+    mRulesFiles.insert(filePath, cached);
+    mWatcher->addPath(filePath);
+
+    entries = cached.entries;
+    return true;
+}
+
+QSharedPointer<AutoMapper> AutomappingRuleCache::autoMapper(const QString &rulePath,
+                                                            QString &error)
+{
+    const QDateTime lastModified = QFileInfo(rulePath).lastModified();
+
+    auto it = mRuleMaps.constFind(rulePath);
+    if (it != mRuleMaps.constEnd()) {
+        if (it.value().lastModified == lastModified) {
+            error = it.value().readError;
+            return it.value().autoMapper;
+        }
+
+        // Changed without us being notified (yet)
+        invalidate(rulePath);
+    }
+
+    RuleMap cached;
+    cached.lastModified = lastModified;
+
+    TmxMapFormat tmxFormat;
+
+    if (Map *rules = tmxFormat.read(rulePath)) {
+        TilesetManager *tilesetManager = TilesetManager::instance();
+        tilesetManager->addReferences(rules->tilesets());
+
+        cached.autoMapper = QSharedPointer<AutoMapper>::create(rules, rulePath);
+    } else {
+        cached.readError = tmxFormat.errorString();
+    }
+
+    // Also failed reads are remembered, until the file changes
+    mRuleMaps.insert(rulePath, cached);
+    mWatcher->addPath(rulePath);
+
+    error = cached.readError;
+    return cached.autoMapper;
+}
+
+void AutomappingRuleCache::fileChanged(const QString &path)
+{
+    // Collect changes for a bit, since saving a file may trigger several
+    // change notifications.
+    mChangedFiles.insert(path);
+    mChangedFilesTimer.start();
+}
+
+void AutomappingRuleCache::fileChangedTimeout()
+{
+    bool changed = false;
+
+    for (const QString &path : mChangedFiles) {
+        const QDateTime lastModified = QFileInfo(path).lastModified();
+
+        // Entries may already have been reloaded by a lookup
+        auto rulesFile = mRulesFiles.constFind(path);
+        if (rulesFile != mRulesFiles.constEnd()
+                && rulesFile.value().lastModified != lastModified) {
+            invalidate(path);
+            changed = true;
+        }
+
+        auto ruleMap = mRuleMaps.constFind(path);
+        if (ruleMap != mRuleMaps.constEnd()
+                && ruleMap.value().lastModified != lastModified) {
+            invalidate(path);
+            changed = true;
+        }
+    }
+
+    mChangedFiles.clear();
+
+    if (changed)
+        emit rulesChanged();
+}
+
+/**
+ * Drops the cached entry for the given \a path. The AutoMapper of a rule map
+ * stays alive as long as it is still referenced elsewhere.
+ */
+void AutomappingRuleCache::invalidate(const QString &path)
+{
+    if (mRulesFiles.remove(path) || mRuleMaps.remove(path))
+        mWatcher->removePath(path);
+}
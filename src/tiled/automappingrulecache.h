@@ -0,0 +1,124 @@
+/*
+ * automappingrulecache.h
+ * Copyright 2016, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUTOMAPPINGRULECACHE_H
+#define AUTOMAPPINGRULECACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTimer>
+
+namespace Tiled {
+namespace Internal {
+
+class AutoMapper;
+class FileSystemWatcher;
+
+/**
+ * The automapping rule cache keeps the parsed rules files and rule maps
+ * around, so that they are shared by all map documents that use them and
+ * don't need to be loaded again each time the current map document changes.
+ *
+ * Entries are keyed by their file path and remember the modification time
+ * of the file they were loaded from. The files are watched for changes, and
+ * only the entries of the files that changed are dropped.
+ */
+class AutomappingRuleCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Requests the rule cache. When the cache doesn't exist yet, it will be
+     * created.
+     */
+    static AutomappingRuleCache *instance();
+
+    /**
+     * Deletes the rule cache instance, when it exists.
+     */
+    static void deleteInstance();
+
+    /**
+     * Returns the rule paths listed in the rules file at \a filePath, with
+     * comments and empty lines skipped and relative paths resolved.
+     *
+     * @return whether the rules file could be opened.
+     */
+    bool rulesFileEntries(const QString &filePath, QStringList &entries);
+
+    /**
+     * Returns the AutoMapper set up for the rule map at \a rulePath. When
+     * the rule map could not be read, a null pointer is returned and
+     * \a error is set to the reason. Errors found in the rules themselves
+     * are reported by AutoMapper::errorString().
+     */
+    QSharedPointer<AutoMapper> autoMapper(const QString &rulePath,
+                                          QString &error);
+
+signals:
+    /**
+     * Emitted when any of the cached rules files or rule maps changed on
+     * disk. Users should look up their rules again.
+     */
+    void rulesChanged();
+
+private slots:
+    void fileChanged(const QString &path);
+    void fileChangedTimeout();
+
+private:
+    Q_DISABLE_COPY(AutomappingRuleCache)
+
+    AutomappingRuleCache();
+    ~AutomappingRuleCache();
+
+    struct RulesFile
+    {
+        QDateTime lastModified;
+        QStringList entries;
+    };
+
+    struct RuleMap
+    {
+        QDateTime lastModified;
+        QSharedPointer<AutoMapper> autoMapper;
+        QString readError;
+    };
+
+    void invalidate(const QString &path);
+
+    static AutomappingRuleCache *mInstance;
+
+    QHash<QString, RulesFile> mRulesFiles;
+    QHash<QString, RuleMap> mRuleMaps;
+    FileSystemWatcher *mWatcher;
+    QSet<QString> mChangedFiles;
+    QTimer mChangedFilesTimer;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // AUTOMAPPINGRULECACHE_H
@@ -0,0 +1,537 @@
+/*
+ * batchexporter.cpp
+ * Copyright 2016, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batchexporter.h"
+
+#include "imagelayer.h"
+#include "map.h"
+#include "mapformat.h"
+#include "mapreader.h"
+#include "pluginmanager.h"
+#include "savejournal.h"
+#include "tile.h"
+#include "tileset.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+static const int CacheVersion = 2;
+
+/**
+ * Returns the first file extension in the given \a nameFilter, including
+ * the dot.
+ */
+static QString firstExtension(const QString &nameFilter)
+{
+    static const QRegularExpression extension(QLatin1String("\\*(\\.[^\\s)]+)"));
+    return extension.match(nameFilter).captured(1);
+}
+
+BatchExporter::BatchExporter()
+{
+}
+
+BatchExporter::~BatchExporter()
+{
+    qDeleteAll(mFormatInstances);
+}
+
+/**
+ * Reads the manifest from the given \a fileName and determines the list of
+ * exports. Returns whether this was successful. When not, the error can be
+ * retrieved using errorString().
+ */
+bool BatchExporter::loadManifest(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = tr("Could not open manifest: %1").arg(file.errorString());
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        mError = tr("Error parsing manifest: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    const QFileInfo manifestInfo(fileName);
+    const QDir manifestDir = manifestInfo.absoluteDir();
+    mCacheFileName = manifestDir.filePath(manifestInfo.completeBaseName() +
+                                          QLatin1String(".exportcache"));
+
+    const QJsonArray exports = document.object().value(QLatin1String("exports")).toArray();
+    for (const QJsonValue &value : exports) {
+        const QJsonObject entry = value.toObject();
+        const QString source = entry.value(QLatin1String("source")).toString();
+        const QString target = entry.value(QLatin1String("target")).toString();
+        const QString filter = entry.value(QLatin1String("format")).toString();
+
+        if (source.isEmpty() || target.isEmpty()) {
+            mError = tr("Each export needs a source and a target");
+            return false;
+        }
+
+        MapFormat *format = nullptr;
+        if (!filter.isEmpty()) {
+            format = formatForFilter(filter);
+            if (!format) {
+                mError = tr("Format not recognized: %1").arg(filter);
+                return false;
+            }
+        }
+
+        const QString sourcePath = manifestDir.absoluteFilePath(source);
+        const QString targetPath = manifestDir.absoluteFilePath(target);
+        const QFileInfo sourceInfo(sourcePath);
+
+        if (sourceInfo.fileName().contains(QLatin1Char('*')) ||
+                sourceInfo.fileName().contains(QLatin1Char('?'))) {
+            if (!format) {
+                mError = tr("A format is needed when using wildcards: %1").arg(source);
+                return false;
+            }
+
+            const QDir sourceDir = sourceInfo.absoluteDir();
+            const QDir targetDir(targetPath);
+            const QString extension = firstExtension(format->nameFilter());
+            const QStringList fileNames = sourceDir.entryList(QStringList(sourceInfo.fileName()),
+                                                              QDir::Files, QDir::Name);
+
+            for (const QString &sourceFileName : fileNames) {
+                addExport(sourceDir.filePath(sourceFileName),
+                          targetDir.filePath(QFileInfo(sourceFileName).completeBaseName() + extension),
+                          format);
+            }
+        } else {
+            if (!format) {
+                format = formatForFile(targetPath);
+                if (!format) {
+                    mError = tr("No unique exporter found for target file: %1").arg(target);
+                    return false;
+                }
+            }
+
+            addExport(sourcePath, targetPath, format);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Adds an export of \a source to \a targetFileName. Exports of the same
+ * source are grouped in a single job.
+ */
+void BatchExporter::addExport(const QString &source,
+                              const QString &targetFileName,
+                              MapFormat *format)
+{
+    int index = mJobIndexes.value(source, -1);
+    if (index == -1) {
+        index = mJobs.size();
+        mJobs.append(Job());
+        mJobs.last().source = source;
+        mJobIndexes.insert(source, index);
+    }
+
+    Target target;
+    target.fileName = targetFileName;
+    target.format = format;
+    mJobs[index].targets.append(target);
+}
+
+/**
+ * Performs all exports, skipping those that are already up to date. Returns
+ * whether all exports were successful.
+ */
+bool BatchExporter::exportMaps()
+{
+    readCache();
+
+    // Checking whether the exports are up to date hashes their known
+    // dependencies. Together with the sources and their journals, these are
+    // hashed before any map is read, so that files changing during the
+    // export are exported again on the next run.
+    QtConcurrent::blockingMap(mJobs, [this] (Job &job) {
+        bool upToDate = true;
+        for (Target &target : job.targets) {
+            if (isUpToDate(job, target))
+                target.result = Target::UpToDate;
+            else
+                upToDate = false;
+        }
+
+        if (!upToDate) {
+            fileHash(job.source);
+            fileHash(SaveJournal::fileName(job.source));
+        }
+    });
+
+    // Only a limited number of maps is kept in memory at the same time
+    const int batchSize = qMax(1, QThread::idealThreadCount()) * 2;
+    QVector<Job*> batch;
+
+    for (Job &job : mJobs) {
+        const bool allUpToDate = std::all_of(job.targets.begin(), job.targets.end(),
+                                             [] (const Target &target) {
+            return target.result == Target::UpToDate;
+        });
+        if (allUpToDate)
+            continue;
+
+        batch.append(&job);
+        if (batch.size() == batchSize) {
+            exportBatch(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty())
+        exportBatch(batch);
+
+    int exported = 0;
+    int upToDate = 0;
+    int failed = 0;
+
+    for (const Job &job : mJobs) {
+        for (const Target &target : job.targets) {
+            switch (target.result) {
+            case Target::Exported:
+                if (job.cacheable)
+                    mCache.insert(cacheKey(job, target), job.dependencies);
+                else
+                    mCache.remove(cacheKey(job, target));
+                ++exported;
+                break;
+            case Target::UpToDate:
+                ++upToDate;
+                break;
+            case Target::Pending:
+            case Target::Failed:
+                mCache.remove(cacheKey(job, target));
+                qWarning() << qPrintable(tr("Failed to export %1 to %2: %3")
+                                         .arg(job.source, target.fileName, target.error));
+                ++failed;
+                break;
+            }
+        }
+    }
+
+    writeCache();
+
+    qWarning() << qPrintable(tr("Exported %1 maps, %2 up to date, %3 failed")
+                             .arg(exported).arg(upToDate).arg(failed));
+
+    return failed == 0;
+}
+
+/**
+ * Reads the maps of the given jobs and writes them in parallel. Maps contain
+ * pixmaps, which may only be used on the main thread, so they are read and
+ * deleted here.
+ */
+void BatchExporter::exportBatch(QVector<Job*> &batch)
+{
+    for (Job *job : batch)
+        read(*job);
+
+    QtConcurrent::blockingMap(batch, [this] (Job *job) {
+        if (!job->map)
+            return;
+
+        for (auto it = job->dependencies.begin(); it != job->dependencies.end(); ++it)
+            it.value() = fileHash(it.key());
+
+        for (Target &target : job->targets)
+            if (MapFormat *format = formatInstance(target.format))
+                write(*job, target, format);
+    });
+
+    // Formats that can't be instantiated for each thread are only used from
+    // the main thread
+    for (Job *job : batch)
+        for (Target &target : job->targets)
+            write(*job, target, target.format);
+
+    for (Job *job : batch) {
+        delete job->map;
+        job->map = nullptr;
+    }
+}
+
+MapFormat *BatchExporter::formatForFilter(const QString &nameFilter) const
+{
+    for (MapFormat *format : PluginManager::objects<MapFormat>()) {
+        if (!format->hasCapabilities(MapFormat::Write))
+            continue;
+        if (format->nameFilter().compare(nameFilter, Qt::CaseInsensitive) == 0)
+            return format;
+    }
+    return nullptr;
+}
+
+/**
+ * Returns the format matching the extension of the given \a fileName, or
+ * null when no or multiple formats match.
+ */
+MapFormat *BatchExporter::formatForFile(const QString &fileName) const
+{
+    const QString suffix = QFileInfo(fileName).completeSuffix();
+    MapFormat *chosenFormat = nullptr;
+
+    for (MapFormat *format : PluginManager::objects<MapFormat>()) {
+        if (!format->hasCapabilities(MapFormat::Write))
+            continue;
+        if (format->nameFilter().contains(suffix, Qt::CaseInsensitive)) {
+            if (chosenFormat)
+                return nullptr;
+            chosenFormat = format;
+        }
+    }
+
+    return chosenFormat;
+}
+
+/**
+ * Reads the map of the given \a job and determines the files it depends on.
+ * Called from the main thread.
+ */
+void BatchExporter::read(Job &job)
+{
+    const QDateTime readTime = QDateTime::currentDateTime();
+
+    MapReader reader;
+    job.map = reader.readMap(job.source);
+    if (!job.map) {
+        for (Target &target : job.targets) {
+            if (target.result == Target::Pending) {
+                target.result = Target::Failed;
+                target.error = reader.errorString();
+            }
+        }
+        return;
+    }
+
+    job.dependencies = dependencies(job.map, job.source);
+
+    // Files this map did not depend on before could not be hashed before
+    // reading it. When one of them may have changed since it was read, the
+    // export is not cached.
+    QMutexLocker locker(&mFileHashesMutex);
+    for (auto it = job.dependencies.begin(); it != job.dependencies.end(); ++it) {
+        if (mFileHashes.contains(it.key()))
+            continue;
+        if (QFileInfo(it.key()).lastModified().addSecs(1) >= readTime)
+            job.cacheable = false;
+    }
+}
+
+/**
+ * Writes the map of the given \a job to \a target using \a format, unless
+ * it was already written or doesn't need to be.
+ */
+void BatchExporter::write(const Job &job, Target &target, MapFormat *format)
+{
+    if (target.result != Target::Pending)
+        return;
+
+    QDir().mkpath(QFileInfo(target.fileName).absolutePath());
+
+    if (format->write(job.map, target.fileName)) {
+        target.result = Target::Exported;
+    } else {
+        target.result = Target::Failed;
+        target.error = format->errorString();
+    }
+}
+
+/**
+ * Returns whether the given \a target of \a job exists and none of the
+ * files it depended on changed since it was last exported.
+ */
+bool BatchExporter::isUpToDate(const Job &job, const Target &target)
+{
+    const auto it = mCache.constFind(cacheKey(job, target));
+    if (it == mCache.constEnd() || !QFile::exists(target.fileName))
+        return false;
+
+    const QMap<QString, QByteArray> &dependencies = it.value();
+    if (dependencies.isEmpty())
+        return false;
+
+    for (auto dep = dependencies.begin(); dep != dependencies.end(); ++dep)
+        if (fileHash(dep.key()) != dep.value())
+            return false;
+
+    return true;
+}
+
+/**
+ * Returns the hash of the contents of the given file. Since tilesets and
+ * images are often shared between many maps, the hashes are remembered.
+ */
+QByteArray BatchExporter::fileHash(const QString &fileName)
+{
+    {
+        QMutexLocker locker(&mFileHashesMutex);
+        const auto it = mFileHashes.constFind(fileName);
+        if (it != mFileHashes.constEnd())
+            return it.value();
+    }
+
+    QByteArray hash;
+
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash cryptographicHash(QCryptographicHash::Sha1);
+        cryptographicHash.addData(&file);
+        hash = cryptographicHash.result().toHex();
+    }
+
+    QMutexLocker locker(&mFileHashesMutex);
+    mFileHashes.insert(fileName, hash);
+    return hash;
+}
+
+/**
+ * Returns an instance of \a format to be used by the current thread, or null
+ * when the format can't be instantiated more than once. The formats store
+ * state in members, like the error string, so an instance can't be used by
+ * multiple threads at the same time.
+ */
+MapFormat *BatchExporter::formatInstance(MapFormat *format)
+{
+    const auto key = qMakePair(QThread::currentThread(), format);
+
+    QMutexLocker locker(&mFormatInstancesMutex);
+    auto it = mFormatInstances.find(key);
+    if (it == mFormatInstances.end()) {
+        MapFormat *instance = format->clone();
+        if (instance)
+            instance->moveToThread(format->thread()); // deleted from there
+        it = mFormatInstances.insert(key, instance);
+    }
+    return it.value();
+}
+
+QString BatchExporter::cacheKey(const Job &job, const Target &target)
+{
+    return target.format->nameFilter() + QLatin1Char('\n') +
+            job.source + QLatin1Char('\n') +
+            target.fileName;
+}
+
+/**
+ * Returns the files the given \a map was loaded from: the map file itself,
+ * its save journal, external tilesets and images. The hashes are left empty.
+ *
+ * The journal is included even when it doesn't exist. Its hash is empty in
+ * that case, so that a journal appearing later invalidates the export.
+ */
+QMap<QString, QByteArray> BatchExporter::dependencies(const Map *map,
+                                                      const QString &mapFile)
+{
+    QMap<QString, QByteArray> files;
+    files.insert(mapFile, QByteArray());
+    files.insert(SaveJournal::fileName(mapFile), QByteArray());
+
+    for (const SharedTileset &tileset : map->tilesets()) {
+        if (!tileset->fileName().isEmpty())
+            files.insert(tileset->fileName(), QByteArray());
+        if (!tileset->imageSource().isEmpty())
+            files.insert(tileset->imageSource(), QByteArray());
+
+        for (const Tile *tile : tileset->tiles())
+            if (!tile->imageSource().isEmpty())
+                files.insert(tile->imageSource(), QByteArray());
+    }
+
+    for (const Layer *layer : map->layers()) {
+        if (const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer))
+            if (!imageLayer->imageSource().isEmpty())
+                files.insert(imageLayer->imageSource(), QByteArray());
+    }
+
+    return files;
+}
+
+void BatchExporter::readCache()
+{
+    QFile file(mCacheFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject cache = QJsonDocument::fromJson(file.readAll()).object();
+    if (cache.value(QLatin1String("version")).toInt() != CacheVersion)
+        return;
+
+    const QJsonObject entries = cache.value(QLatin1String("entries")).toObject();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        const QJsonObject hashes = it.value().toObject();
+
+        QMap<QString, QByteArray> dependencies;
+        for (auto hash = hashes.begin(); hash != hashes.end(); ++hash)
+            dependencies.insert(hash.key(), hash.value().toString().toLatin1());
+
+        mCache.insert(it.key(), dependencies);
+    }
+}
+
+void BatchExporter::writeCache()
+{
+    QJsonObject entries;
+    for (auto it = mCache.constBegin(); it != mCache.constEnd(); ++it) {
+        QJsonObject hashes;
+        const QMap<QString, QByteArray> &dependencies = it.value();
+        for (auto hash = dependencies.begin(); hash != dependencies.end(); ++hash)
+            hashes.insert(hash.key(), QString::fromLatin1(hash.value()));
+
+        entries.insert(it.key(), hashes);
+    }
+
+    QJsonObject cache;
+    cache.insert(QLatin1String("version"), CacheVersion);
+    cache.insert(QLatin1String("entries"), entries);
+
+    QSaveFile file(mCacheFileName);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(QJsonDocument(cache).toJson()) == -1 ||
+            !file.commit()) {
+        qWarning() << qPrintable(tr("Failed to write export cache: %1")
+                                 .arg(file.errorString()));
+    }
+}
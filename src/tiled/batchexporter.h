@@ -0,0 +1,150 @@
+/*
+ * batchexporter.h
+ * Copyright 2016, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILED_INTERNAL_BATCHEXPORTER_H
+#define TILED_INTERNAL_BATCHEXPORTER_H
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class QThread;
+
+namespace Tiled {
+
+class Map;
+class MapFormat;
+
+namespace Internal {
+
+/**
+ * Exports a set of maps as described by a manifest file, as used by the
+ * --export-batch command line option.
+ *
+ * The manifest is a JSON file with an "exports" array. Each entry has a
+ * "source" map, a "target" file and optionally a "format", which is the
+ * name filter of the map format as listed by --export-formats. The source
+ * may use wildcards in its file name, in which case the target is taken to
+ * be a directory and a format has to be given. Relative paths are relative
+ * to the manifest.
+ *
+ * Each map is read once on the main thread and then written to all of its
+ * targets, with different maps being written in parallel. The files each
+ * export depended on are stored with their hash in a cache file next to the
+ * manifest, so that exports of which none of the inputs changed can be
+ * skipped.
+ */
+class BatchExporter
+{
+    Q_DECLARE_TR_FUNCTIONS(BatchExporter)
+
+public:
+    BatchExporter();
+    ~BatchExporter();
+
+    bool loadManifest(const QString &fileName);
+
+    bool exportMaps();
+
+    QString errorString() const { return mError; }
+
+private:
+    struct Target
+    {
+        enum Result {
+            Pending,
+            Exported,
+            UpToDate,
+            Failed
+        };
+
+        Target()
+            : format(nullptr)
+            , result(Pending)
+        {}
+
+        QString fileName;
+        MapFormat *format;
+
+        Result result;
+        QString error;
+    };
+
+    /**
+     * A source map with all the targets it is exported to, so that each map
+     * is read only once.
+     */
+    struct Job
+    {
+        Job()
+            : map(nullptr)
+            , cacheable(true)
+        {}
+
+        QString source;
+        QVector<Target> targets;
+        Map *map;
+
+        bool cacheable;
+        QMap<QString, QByteArray> dependencies;
+    };
+
+    MapFormat *formatForFilter(const QString &nameFilter) const;
+    MapFormat *formatForFile(const QString &fileName) const;
+
+    void addExport(const QString &source, const QString &targetFileName,
+                   MapFormat *format);
+
+    void exportBatch(QVector<Job*> &batch);
+    void read(Job &job);
+    void write(const Job &job, Target &target, MapFormat *format);
+    bool isUpToDate(const Job &job, const Target &target);
+    QByteArray fileHash(const QString &fileName);
+    MapFormat *formatInstance(MapFormat *format);
+
+    static QString cacheKey(const Job &job, const Target &target);
+    static QMap<QString, QByteArray> dependencies(const Map *map,
+                                                  const QString &mapFile);
+
+    void readCache();
+    void writeCache();
+
+    QString mError;
+    QString mCacheFileName;
+    QVector<Job> mJobs;
+    QHash<QString, int> mJobIndexes;
+
+    QHash<QString, QMap<QString, QByteArray>> mCache;
+
+    QMutex mFileHashesMutex;
+    QHash<QString, QByteArray> mFileHashes;
+
+    QMutex mFormatInstancesMutex;
+    QHash<QPair<QThread*, MapFormat*>, MapFormat*> mFormatInstances;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // TILED_INTERNAL_BATCHEXPORTER_H
@@ -133,12 +133,16 @@ void BrushItem::paint(QPainter *painter,
     QColor insideMapHighlight = QApplication::palette().highlight().color();
     insideMapHighlight.setAlpha(64);
     QColor outsideMapHighlight = QColor(255, 0, 0, 64);
-    
-    int mapWidth = mMapDocument->map()->width();
-    int mapHeight = mMapDocument->map()->height();
-    QRegion mapRegion = QRegion(0, 0, mapWidth, mapHeight);
-    QRegion insideMapRegion = mRegion.intersected(mapRegion);
-    QRegion outsideMapRegion = mRegion.subtracted(mapRegion);
+
+    // Split the region only when it or the map size changed, rather than on
+    // each repaint
+    const QSize mapSize = mMapDocument->map()->size();
+    if (mSplitForMapSize != mapSize) {
+        const QRegion mapRegion(QRect(QPoint(), mapSize));
+        mInsideMapRegion = mRegion.intersected(mapRegion);
+        mOutsideMapRegion = mRegion.subtracted(mapRegion);
+        mSplitForMapSize = mapSize;
+    }
 
     const MapRenderer *renderer = mMapDocument->renderer();
     if (mTileLayer) {
@@ -148,10 +152,10 @@ void BrushItem::paint(QPainter *painter,
         painter->setOpacity(opacity);
     }
 
-    renderer->drawTileSelection(painter, insideMapRegion,
+    renderer->drawTileSelection(painter, mInsideMapRegion,
                                 insideMapHighlight,
                                 option->exposedRect);
-    renderer->drawTileSelection(painter, outsideMapRegion,
+    renderer->drawTileSelection(painter, mOutsideMapRegion,
                                 outsideMapHighlight,
                                 option->exposedRect);
 }
@@ -160,6 +164,9 @@ void BrushItem::updateBoundingRect()
 {
     prepareGeometryChange();
 
+    // The region changed, so it needs to be split again
+    mSplitForMapSize = QSize();
+
     if (!mMapDocument) {
         mBoundingRect = QRectF();
         return;
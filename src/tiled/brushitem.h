@@ -68,6 +68,11 @@ private:
     SharedTileLayer mTileLayer;
     QRegion mRegion;
     QRectF mBoundingRect;
+
+    // Parts of mRegion inside and outside of a map of the given size
+    QRegion mInsideMapRegion;
+    QRegion mOutsideMapRegion;
+    QSize mSplitForMapSize;
 };
 
 /**
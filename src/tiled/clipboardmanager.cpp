@@ -24,6 +24,8 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
+#include "mapreader.h"
+#include "mapwriter.h"
 #include "maprenderer.h"
 #include "mapview.h"
 #include "objectgroup.h"
@@ -33,6 +35,7 @@
 #include "tilelayer.h"
 
 #include <QApplication>
+#include <QBuffer>
 #include <QClipboard>
 #include <QMimeData>
 #include <QSet>
@@ -43,6 +46,79 @@ static const char * const TMX_MIMETYPE = "text/tmx";
 using namespace Tiled;
 using namespace Tiled::Internal;
 
+namespace {
+
+/**
+ * Mime data holding a map. Pasting within Tiled uses the map directly, while
+ * it is only serialized to TMX when the data is requested by another
+ * application.
+ */
+class MapMimeData : public QMimeData
+{
+public:
+    explicit MapMimeData(const Map *map)
+        : mMap(new Map(*map))
+    {}
+
+    Map *createMap() const;
+
+    bool hasFormat(const QString &mimeType) const override
+    { return mimeType == QLatin1String(TMX_MIMETYPE); }
+
+    QStringList formats() const override
+    { return QStringList(QLatin1String(TMX_MIMETYPE)); }
+
+protected:
+    QVariant retrieveData(const QString &mimeType,
+                          QVariant::Type type) const override
+    {
+        Q_UNUSED(type)
+
+        if (mimeType != QLatin1String(TMX_MIMETYPE))
+            return QVariant();
+
+        if (mData.isEmpty())
+            mData = TmxMapFormat().toByteArray(mMap.data());
+
+        return mData;
+    }
+
+private:
+    QScopedPointer<Map> mMap;
+    mutable QByteArray mData;
+};
+
+/**
+ * Returns a copy of the map. External tilesets are shared, like they are when
+ * loading a map. Embedded tilesets are copied, since they would otherwise
+ * end up being shared between the maps they are pasted into.
+ */
+Map *MapMimeData::createMap() const
+{
+    QScopedPointer<Map> map(new Map(*mMap));
+
+    for (const SharedTileset &tileset : mMap->tilesets()) {
+        if (tileset->isExternal())
+            continue;
+
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        MapWriter().writeTileset(*tileset, &buffer);
+        buffer.close();
+
+        buffer.open(QIODevice::ReadOnly);
+        SharedTileset copy = MapReader().readTileset(&buffer);
+        if (!copy)
+            return nullptr;
+
+        map->replaceTileset(tileset, copy);
+    }
+
+    return map.take();
+}
+
+} // anonymous namespace
+
 ClipboardManager *ClipboardManager::mInstance;
 
 ClipboardManager::ClipboardManager() :
@@ -54,6 +130,18 @@ ClipboardManager::ClipboardManager() :
     updateHasMap();
 }
 
+ClipboardManager::~ClipboardManager()
+{
+    // The copied map refers to tilesets which may not outlive the application
+    // object, so the clipboard is left with only the TMX data
+    if (const MapMimeData *mapData = dynamic_cast<const MapMimeData*>(mClipboard->mimeData())) {
+        QMimeData *mimeData = new QMimeData;
+        mimeData->setData(QLatin1String(TMX_MIMETYPE),
+                          mapData->data(QLatin1String(TMX_MIMETYPE)));
+        mClipboard->setMimeData(mimeData);
+    }
+}
+
 ClipboardManager *ClipboardManager::instance()
 {
     if (!mInstance)
@@ -70,6 +158,13 @@ void ClipboardManager::deleteInstance()
 Map *ClipboardManager::map() const
 {
     const QMimeData *mimeData = mClipboard->mimeData();
+
+    // Skip the TMX round-trip when the map was copied by this instance. Only
+    // embedded tilesets need to be copied, since tile layer data is
+    // implicitly shared.
+    if (const MapMimeData *mapData = dynamic_cast<const MapMimeData*>(mimeData))
+        return mapData->createMap();
+
     const QByteArray data = mimeData->data(QLatin1String(TMX_MIMETYPE));
     if (data.isEmpty())
         return nullptr;
@@ -80,12 +175,7 @@ Map *ClipboardManager::map() const
 
 void ClipboardManager::setMap(const Map *map)
 {
-    TmxMapFormat format;
-
-    QMimeData *mimeData = new QMimeData;
-    mimeData->setData(QLatin1String(TMX_MIMETYPE), format.toByteArray(map));
-
-    mClipboard->setMimeData(mimeData);
+    mClipboard->setMimeData(new MapMimeData(map));
 }
 
 void ClipboardManager::copySelection(const MapDocument *mapDocument)
@@ -61,12 +61,14 @@ public:
 
     /**
      * Retrieves the map from the clipboard. Returns 0 when there was no map or
-     * loading failed.
+     * loading failed. The caller takes ownership of the returned map.
      */
     Map *map() const;
 
     /**
-     * Sets the given map on the clipboard.
+     * Sets the given map on the clipboard. A copy of the map is kept for
+     * pasting within Tiled, while the TMX data for other applications is only
+     * created when requested.
      */
     void setMap(const Map *map);
 
@@ -104,6 +106,7 @@ private slots:
 
 private:
     ClipboardManager();
+    ~ClipboardManager();
 
     Q_DISABLE_COPY(ClipboardManager)
 
@@ -30,6 +30,7 @@
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "mapview.h"
+#include "preferences.h"
 #include "tilesetmanager.h"
 #include "zoomable.h"
 
@@ -359,6 +360,7 @@ void DocumentManager::addDocument(MapDocument *mapDocument)
             SLOT(fileNameChanged(QString,QString)));
     connect(mapDocument, SIGNAL(modifiedChanged()), SLOT(updateDocumentTab()));
     connect(mapDocument, SIGNAL(saved()), SLOT(documentSaved()));
+    connect(mapDocument, SIGNAL(saveFailed(QString)), SLOT(documentSaveFailed(QString)));
 
     connect(container, SIGNAL(reload()), SLOT(reloadRequested()));
 
@@ -404,6 +406,15 @@ bool DocumentManager::reloadDocumentAt(int index)
 {
     MapDocument *oldDocument = mDocuments.at(index);
 
+    // When possible, only apply the changes to keep the undo history and to
+    // avoid rebuilding the whole scene
+    if (Preferences::instance()->reloadMapsIncrementally() &&
+            oldDocument->reloadIncrementally()) {
+        MapViewContainer *container = static_cast<MapViewContainer*>(mTabWidget->widget(index));
+        container->setFileChangedWarningVisible(false);
+        return true;
+    }
+
     QString error;
     MapDocument *newDocument = MapDocument::load(oldDocument->fileName(),
                                                  oldDocument->readerFormat(),
@@ -539,6 +550,12 @@ void DocumentManager::documentSaved()
     container->setFileChangedWarningVisible(false);
 }
 
+void DocumentManager::documentSaveFailed(const QString &error)
+{
+    MapDocument *document = static_cast<MapDocument*>(sender());
+    emit saveError(document, error);
+}
+
 void DocumentManager::documentTabMoved(int from, int to)
 {
     mDocuments.move(from, to);
@@ -580,6 +597,8 @@ void DocumentManager::fileChanged(const QString &fileName)
     MapDocument *document = mDocuments.at(index);
 
     // Ignore change event when it seems to be our own save
+    if (document->isSaving())
+        return;
     if (QFileInfo(fileName).lastModified() == document->lastSaved())
         return;
 
@@ -179,6 +179,11 @@ signals:
      */
     void reloadError(const QString &error);
 
+    /**
+     * Emitted when saving the given \a mapDocument failed.
+     */
+    void saveError(MapDocument *mapDocument, const QString &error);
+
 public slots:
     void switchToLeftDocument();
     void switchToRightDocument();
@@ -191,6 +196,7 @@ private slots:
                          const QString &oldFileName);
     void updateDocumentTab();
     void documentSaved();
+    void documentSaveFailed(const QString &error);
     void documentTabMoved(int from, int to);
     void tabContextMenuRequested(const QPoint &pos);
 
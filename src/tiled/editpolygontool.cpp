@@ -40,6 +40,7 @@
 #include <QGraphicsView>
 #include <QMenu>
 #include <QPainter>
+#include <QPainterPath>
 #include <QPalette>
 #include <QUndoStack>
 
@@ -246,7 +247,7 @@ void EditPolygonTool::mousePressed(QGraphicsSceneMouseEvent *event)
                                                                Qt::DescendingOrder,
                                                                viewTransform(event));
 
-        mClickedObjectItem = first<MapObjectItem>(items);
+        mClickedObjectItem = topMostObjectItemAt(mStart);
         mClickedHandle = first<PointHandle>(items);
         break;
     }
@@ -438,16 +439,13 @@ void EditPolygonTool::updateSelection(QGraphicsSceneMouseEvent *event)
 
     if (oldSelection.isEmpty()) {
         // Allow selecting some map objects only when there aren't any selected
+        QPainterPath area;
+        area.addRect(rect);
+
         QSet<MapObjectItem*> selectedItems;
 
-        foreach (QGraphicsItem *item, mapScene()->items(rect,
-                                                        Qt::IntersectsItemShape,
-                                                        Qt::DescendingOrder,
-                                                        viewTransform(event))) {
-            MapObjectItem *mapObjectItem = dynamic_cast<MapObjectItem*>(item);
-            if (mapObjectItem)
-                selectedItems.insert(mapObjectItem);
-        }
+        foreach (MapObjectItem *mapObjectItem, mapScene()->objectItemsIn(area))
+            selectedItems.insert(mapObjectItem);
 
 
         QSet<MapObjectItem*> newSelection;
@@ -203,6 +203,10 @@ void ExportAsImageDialog::accept()
 
     QPainter painter(&image);
 
+    // Exported images always show the actual tile images
+    const qreal flatColorTileSize = renderer->flatColorTileSize();
+    renderer->setFlatColorTileSize(0);
+
     if (useCurrentScale) {
         if (smoothTransform(mCurrentScale))
             painter.setRenderHints(QPainter::SmoothPixmapTransform);
@@ -274,6 +278,7 @@ void ExportAsImageDialog::accept()
 
     // Restore the previous render flags
     renderer->setFlags(renderFlags);
+    renderer->setFlatColorTileSize(flatColorTileSize);
 
     image.save(fileName);
     mPath = QFileInfo(fileName).path();
@@ -20,6 +20,7 @@
  * this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "batchexporter.h"
 #include "commandlineparser.h"
 #include "mainwindow.h"
 #include "languagemanager.h"
@@ -64,6 +65,7 @@ public:
     bool showedVersion;
     bool disableOpenGL;
     bool exportMap;
+    bool exportBatch;
     bool newInstance;
 
 private:
@@ -71,6 +73,7 @@ private:
     void justQuit();
     void setDisableOpenGL();
     void setExportMap();
+    void setExportBatch();
     void showExportFormats();
     void startNewInstance();
 
@@ -95,6 +98,7 @@ CommandLineHandler::CommandLineHandler()
     , showedVersion(false)
     , disableOpenGL(false)
     , exportMap(false)
+    , exportBatch(false)
     , newInstance(false)
 {
     option<&CommandLineHandler::showVersion>(
@@ -117,6 +121,11 @@ CommandLineHandler::CommandLineHandler()
                 QLatin1String("--export-map"),
                 tr("Export the specified tmx file to target"));
 
+    option<&CommandLineHandler::setExportBatch>(
+                QChar(),
+                QLatin1String("--export-batch"),
+                tr("Export the maps listed in the given manifest file, skipping those that are up to date"));
+
     option<&CommandLineHandler::showExportFormats>(
                 QChar(),
                 QLatin1String("--export-formats"),
@@ -153,6 +162,11 @@ void CommandLineHandler::setExportMap()
     exportMap = true;
 }
 
+void CommandLineHandler::setExportBatch()
+{
+    exportBatch = true;
+}
+
 void CommandLineHandler::showExportFormats()
 {
     PluginManager::instance()->loadPlugins();
@@ -294,6 +308,22 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (commandLine.exportBatch) {
+        if (commandLine.filesToOpen().length() != 1) {
+            qWarning() << qPrintable(QCoreApplication::translate("Command line",
+                                                                 "Export syntax is --export-batch <manifest file>"));
+            return 1;
+        }
+
+        BatchExporter exporter;
+        if (!exporter.loadManifest(commandLine.filesToOpen().first())) {
+            qWarning() << qPrintable(exporter.errorString());
+            return 1;
+        }
+
+        return exporter.exportMaps() ? 0 : 1;
+    }
+
     if (!commandLine.filesToOpen().isEmpty() && !commandLine.newInstance) {
         // Convert files to absolute paths because the already running Tiled
         // instance likely does not have the same working directory.
@@ -30,6 +30,7 @@
 
 #include "aboutdialog.h"
 #include "automappingmanager.h"
+#include "automappingrulecache.h"
 #include "addremovetileset.h"
 #include "createobjecttool.h"
 #include "createrectangleobjecttool.h"
@@ -105,6 +106,7 @@
 #include <QLabel>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QMutex>
 #include <QRegExp>
 #include <QScrollBar>
 #include <QSessionManager>
@@ -404,7 +406,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     connect(mUi->actionOpen, SIGNAL(triggered()), SLOT(openFile()));
     connect(mUi->actionClearRecentFiles, SIGNAL(triggered()),
             SLOT(clearRecentFiles()));
-    connect(mUi->actionSave, SIGNAL(triggered()), SLOT(saveFile()));
+    connect(mUi->actionSave, SIGNAL(triggered()), SLOT(saveFileInBackground()));
     connect(mUi->actionSaveAs, SIGNAL(triggered()), SLOT(saveFileAs()));
     connect(mUi->actionSaveAll, SIGNAL(triggered()), SLOT(saveAll()));
     connect(mUi->actionExportAsImage, SIGNAL(triggered()), SLOT(exportAsImage()));
@@ -601,6 +603,8 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
             this, SLOT(closeMapDocument(int)));
     connect(mDocumentManager, SIGNAL(reloadError(QString)),
             this, SLOT(reloadError(QString)));
+    connect(mDocumentManager, SIGNAL(saveError(MapDocument*,QString)),
+            this, SLOT(saveError(MapDocument*,QString)));
 
     QShortcut *switchToLeftDocument = new QShortcut(tr("Alt+Left"), this);
     connect(switchToLeftDocument, SIGNAL(activated()),
@@ -657,6 +661,11 @@ MainWindow::~MainWindow()
     delete mBucketFillTool;
     mBucketFillTool = nullptr;
 
+    // The automapping rules hold references to tilesets as well
+    delete mAutomappingManager;
+    mAutomappingManager = nullptr;
+    AutomappingRuleCache::deleteInstance();
+
     TilesetManager::deleteInstance();
     DocumentManager::deleteInstance();
     Preferences::deleteInstance();
@@ -896,6 +905,26 @@ bool MainWindow::saveFile()
         return saveFile(currentFileName);
 }
 
+/**
+ * Saves the current map to its file without blocking the user interface.
+ * Errors are reported through DocumentManager::saveError.
+ */
+void MainWindow::saveFileInBackground()
+{
+    if (!mMapDocument)
+        return;
+
+    const QString currentFileName = mMapDocument->fileName();
+
+    if (currentFileName.isEmpty()) {
+        saveFileAs();
+        return;
+    }
+
+    mMapDocument->saveInBackground(currentFileName);
+    setRecentFile(currentFileName);
+}
+
 bool MainWindow::saveFileAs()
 {
     const QString tmxFilter = TmxMapFormat().nameFilter();
@@ -955,16 +984,13 @@ void MainWindow::saveAll()
             continue;
 
         QString fileName(mapDoc->fileName());
-        QString error;
 
         if (fileName.isEmpty()) {
             mDocumentManager->switchToDocument(mapDoc);
             if (!saveFileAs())
                 return;
-        } else if (!mapDoc->save(fileName, &error)) {
-            mDocumentManager->switchToDocument(mapDoc);
-            QMessageBox::critical(this, tr("Error Saving Map"), error);
-            return;
+        } else {
+            mapDoc->saveInBackground(fileName);
         }
 
         setRecentFile(fileName);
@@ -973,7 +999,13 @@ void MainWindow::saveAll()
 
 bool MainWindow::confirmSave(MapDocument *mapDocument)
 {
-    if (!mapDocument || !mapDocument->isModified())
+    if (!mapDocument)
+        return true;
+
+    // A save in progress may still clear the modified state
+    mapDocument->waitForSave();
+
+    if (!mapDocument->isModified())
         return true;
 
     mDocumentManager->switchToDocument(mapDocument);
@@ -1016,14 +1048,21 @@ void MainWindow::export_()
         if (!exportFormat)
             exportFormat = &tmxFormat;
 
-        if (exportFormat->write(mMapDocument->map(), exportFileName)) {
+        bool exported;
+        QString error;
+        {
+            QMutexLocker locker(MapDocument::formatMutex());
+            exported = exportFormat->write(mMapDocument->map(), exportFileName);
+            error = exportFormat->errorString();
+        }
+
+        if (exported) {
             statusBar()->showMessage(tr("Exported to %1").arg(exportFileName),
                                      3000);
             return;
         }
 
-        QMessageBox::critical(this, tr("Error Exporting Map"),
-                              exportFormat->errorString());
+        QMessageBox::critical(this, tr("Error Exporting Map"), error);
     }
 
     // fall back when no successful export happened
@@ -1138,9 +1177,16 @@ void MainWindow::exportAs()
     pref->setLastPath(Preferences::ExportedFile, QFileInfo(fileName).path());
     mSettings.setValue(QLatin1String("lastUsedExportFilter"), selectedFilter);
 
-    if (!chosenFormat->write(mMapDocument->map(), fileName)) {
-        QMessageBox::critical(this, tr("Error Exporting Map"),
-                              chosenFormat->errorString());
+    bool exported;
+    QString error;
+    {
+        QMutexLocker locker(MapDocument::formatMutex());
+        exported = chosenFormat->write(mMapDocument->map(), fileName);
+        error = chosenFormat->errorString();
+    }
+
+    if (!exported) {
+        QMessageBox::critical(this, tr("Error Exporting Map"), error);
     } else {
         // Remember export parameters, so subsequent exports can be done faster
         mMapDocument->setLastExportFileName(fileName);
@@ -1319,6 +1365,10 @@ void MainWindow::reloadTilesets()
     if (!mMapDocument)
         return;
 
+    // Maps being saved in the background may share these tilesets
+    for (MapDocument *mapDocument : mDocumentManager->documents())
+        mapDocument->waitForSave();
+
     Map *map = mMapDocument->map();
     TilesetManager *tilesetManager = TilesetManager::instance();
     QVector<SharedTileset> tilesets = map->tilesets();
@@ -1890,3 +1940,9 @@ void MainWindow::reloadError(const QString &error)
 {
     QMessageBox::critical(this, tr("Error Reloading Map"), error);
 }
+
+void MainWindow::saveError(MapDocument *mapDocument, const QString &error)
+{
+    mDocumentManager->switchToDocument(mapDocument);
+    QMessageBox::critical(this, tr("Error Saving Map"), error);
+}
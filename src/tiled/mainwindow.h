@@ -121,6 +121,7 @@ private slots:
     void newMap();
     void openFile();
     bool saveFile();
+    void saveFileInBackground();
     bool saveFileAs();
     void saveAll();
     void export_(); // 'export' is a reserved word
@@ -174,6 +175,7 @@ private slots:
     void closeMapDocument(int index);
 
     void reloadError(const QString &error);
+    void saveError(MapDocument *mapDocument, const QString &error);
     void autoMappingError(bool automatic);
     void autoMappingWarning(bool automatic);
 
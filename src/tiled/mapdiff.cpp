@@ -0,0 +1,422 @@
+/*
+ * mapdiff.cpp
+ * Copyright 2016, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapdiff.h"
+
+#include "addremovemapobject.h"
+#include "changeimagelayerproperties.h"
+#include "changelayer.h"
+#include "changemapproperty.h"
+#include "changeobjectgroupproperties.h"
+#include "changeproperties.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapdocument.h"
+#include "mapobject.h"
+#include "mapobjectmodel.h"
+#include "objectgroup.h"
+#include "renamelayer.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QHash>
+#include <QUndoCommand>
+
+#include <algorithm>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+namespace {
+
+/**
+ * Replaces the cells of a tile layer within a region with those of another
+ * layer. Unlike PaintTileLayer, this ignores the tile selection.
+ */
+class ChangeTileLayerCells : public QUndoCommand
+{
+public:
+    ChangeTileLayerCells(MapDocument *mapDocument,
+                         TileLayer *tileLayer,
+                         const TileLayer *newTileLayer,
+                         const QRegion &region)
+        : QUndoCommand(QCoreApplication::translate("Undo Commands",
+                                                   "Change Tiles"))
+        , mMapDocument(mapDocument)
+        , mTileLayer(tileLayer)
+        , mRegion(region)
+        , mBounds(region.boundingRect())
+        , mOldCells(tileLayer->copy(region))
+        , mNewCells(newTileLayer->copy(region))
+    {
+    }
+
+    ~ChangeTileLayerCells()
+    {
+        delete mOldCells;
+        delete mNewCells;
+    }
+
+    void undo() override { setCells(mOldCells); }
+    void redo() override { setCells(mNewCells); }
+
+private:
+    void setCells(TileLayer *cells)
+    {
+        const QMargins oldMargins = mTileLayer->drawMargins();
+        mTileLayer->setCells(mBounds.x(), mBounds.y(), cells, mRegion);
+
+        if (mTileLayer->drawMargins() != oldMargins)
+            mMapDocument->emitTileLayerDrawMarginsChanged(mTileLayer);
+
+        mMapDocument->emitRegionChanged(mRegion.translated(mTileLayer->position()),
+                                        mTileLayer);
+    }
+
+    MapDocument *mMapDocument;
+    TileLayer *mTileLayer;
+    const QRegion mRegion;
+    const QRect mBounds;
+    TileLayer *mOldCells;
+    TileLayer *mNewCells;
+};
+
+/**
+ * Replaces a map object with another one at the same position in its object
+ * group. Used for objects that were changed in more than one way.
+ */
+class ReplaceMapObject : public QUndoCommand
+{
+public:
+    ReplaceMapObject(MapDocument *mapDocument,
+                     MapObject *mapObject,
+                     MapObject *replacement)
+        : QUndoCommand(QCoreApplication::translate("Undo Commands",
+                                                   "Change Object"))
+        , mMapDocument(mapDocument)
+        , mObjectGroup(mapObject->objectGroup())
+        , mMapObject(mapObject)
+        , mReplacement(replacement)
+    {
+    }
+
+    ~ReplaceMapObject()
+    {
+        // The replacement is always the object that is not in the map
+        delete mReplacement;
+    }
+
+    void undo() override { swap(); }
+    void redo() override { swap(); }
+
+private:
+    void swap()
+    {
+        MapObjectModel *model = mMapDocument->mapObjectModel();
+        const int index = model->removeObject(mObjectGroup, mMapObject);
+        model->insertObject(mObjectGroup, index, mReplacement);
+        std::swap(mMapObject, mReplacement);
+    }
+
+    MapDocument *mMapDocument;
+    ObjectGroup *mObjectGroup;
+    MapObject *mMapObject;
+    MapObject *mReplacement;
+};
+
+bool sameTiles(const Tileset &a, const Tileset &b)
+{
+    for (const Tile *tile : a.tiles()) {
+        const Tile *other = b.findTile(tile->id());
+        if (!other)
+            return false;
+        if (tile->properties() != other->properties() ||
+                tile->probability() != other->probability() ||
+                tile->terrain() != other->terrain() ||
+                tile->frames() != other->frames())
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Returns whether the \a newTileset read from disk can be substituted by the
+ * \a tileset already used by the map.
+ */
+bool equivalentTilesets(const SharedTileset &tileset,
+                        const SharedTileset &newTileset)
+{
+    if (tileset == newTileset)
+        return true;
+
+    if (tileset->isExternal() || newTileset->isExternal())
+        return tileset->fileName() == newTileset->fileName();
+
+    if (tileset->name() != newTileset->name() ||
+            tileset->properties() != newTileset->properties() ||
+            tileset->transparentColor() != newTileset->transparentColor() ||
+            tileset->terrainCount() != newTileset->terrainCount())
+        return false;
+
+    QVector<SharedTileset> candidates;
+    candidates.append(tileset);
+    if (!newTileset->findSimilarTileset(candidates))
+        return false;
+
+    return sameTiles(*tileset, *newTileset);
+}
+
+bool sameObject(const MapObject *a, const MapObject *b)
+{
+    return a->name() == b->name() &&
+            a->type() == b->type() &&
+            a->position() == b->position() &&
+            a->size() == b->size() &&
+            a->shape() == b->shape() &&
+            a->polygon() == b->polygon() &&
+            a->cell() == b->cell() &&
+            a->rotation() == b->rotation() &&
+            a->isVisible() == b->isVisible() &&
+            a->properties() == b->properties();
+}
+
+} // anonymous namespace
+
+MapDiff::MapDiff(MapDocument *mapDocument)
+    : mMapDocument(mapDocument)
+{
+}
+
+MapDiff::~MapDiff()
+{
+    qDeleteAll(mCommands);
+}
+
+/**
+ * Compares the map of the document with the given \a map. Returns whether
+ * the differences could be expressed as undo commands, which can then be
+ * retrieved using takeCommands().
+ *
+ * The tilesets of the given \a map are replaced by the equivalent tilesets
+ * of the document, so the map should be discarded afterwards.
+ */
+bool MapDiff::compare(Map *map)
+{
+    Map *current = mMapDocument->map();
+
+    if (current->orientation() != map->orientation() ||
+            current->width() != map->width() ||
+            current->height() != map->height() ||
+            current->tileWidth() != map->tileWidth() ||
+            current->tileHeight() != map->tileHeight() ||
+            current->hexSideLength() != map->hexSideLength() ||
+            current->staggerAxis() != map->staggerAxis() ||
+            current->staggerIndex() != map->staggerIndex())
+        return false;
+
+    if (!compareTilesets(map))
+        return false;
+
+    if (current->layerCount() != map->layerCount())
+        return false;
+
+    for (int i = 0; i < map->layerCount(); ++i)
+        if (!compareLayer(i, map->layerAt(i)))
+            return false;
+
+    if (current->renderOrder() != map->renderOrder())
+        mCommands.append(new ChangeMapProperty(mMapDocument, map->renderOrder()));
+    if (current->backgroundColor() != map->backgroundColor())
+        mCommands.append(new ChangeMapProperty(mMapDocument, map->backgroundColor()));
+    if (current->layerDataFormat() != map->layerDataFormat())
+        mCommands.append(new ChangeMapProperty(mMapDocument, map->layerDataFormat()));
+
+    compareProperties(tr("Map"), current, map->properties());
+
+    // Not undoable, but making sure new objects don't reuse existing IDs
+    if (map->nextObjectId() > current->nextObjectId())
+        current->setNextObjectId(map->nextObjectId());
+
+    return true;
+}
+
+QList<QUndoCommand*> MapDiff::takeCommands()
+{
+    QList<QUndoCommand*> commands;
+    commands.swap(mCommands);
+    return commands;
+}
+
+/**
+ * Makes sure the tilesets of the given \a map match those of the document,
+ * and replaces them with the tilesets of the document so that the tiles
+ * referenced by both maps can be compared directly.
+ */
+bool MapDiff::compareTilesets(Map *map)
+{
+    const Map *current = mMapDocument->map();
+    const QVector<SharedTileset> tilesets = current->tilesets();
+    const QVector<SharedTileset> newTilesets = map->tilesets();
+
+    if (tilesets.size() != newTilesets.size())
+        return false;
+
+    for (int i = 0; i < tilesets.size(); ++i)
+        if (!equivalentTilesets(tilesets.at(i), newTilesets.at(i)))
+            return false;
+
+    for (int i = 0; i < tilesets.size(); ++i)
+        if (tilesets.at(i) != newTilesets.at(i))
+            map->replaceTileset(newTilesets.at(i), tilesets.at(i));
+
+    return true;
+}
+
+bool MapDiff::compareLayer(int index, Layer *layer)
+{
+    Layer *current = mMapDocument->map()->layerAt(index);
+    if (current->layerType() != layer->layerType())
+        return false;
+
+    switch (layer->layerType()) {
+    case Layer::TileLayerType:
+        if (!compareTileLayer(current->asTileLayer(), layer->asTileLayer()))
+            return false;
+        break;
+    case Layer::ObjectGroupType:
+        if (!compareObjectGroup(current->asObjectGroup(), layer->asObjectGroup()))
+            return false;
+        break;
+    case Layer::ImageLayerType:
+        compareImageLayer(current->asImageLayer(), layer->asImageLayer());
+        break;
+    }
+
+    if (current->name() != layer->name())
+        mCommands.append(new RenameLayer(mMapDocument, index, layer->name()));
+    if (current->opacity() != layer->opacity())
+        mCommands.append(new SetLayerOpacity(mMapDocument, index, layer->opacity()));
+    if (current->isVisible() != layer->isVisible())
+        mCommands.append(new SetLayerVisible(mMapDocument, index, layer->isVisible()));
+    if (current->offset() != layer->offset())
+        mCommands.append(new SetLayerOffset(mMapDocument, index, layer->offset()));
+
+    compareProperties(tr("Layer"), current, layer->properties());
+
+    return true;
+}
+
+bool MapDiff::compareTileLayer(TileLayer *tileLayer, const TileLayer *other)
+{
+    if (tileLayer->bounds() != other->bounds())
+        return false;
+
+    const QRegion diff = tileLayer->computeDiffRegion(other);
+    if (!diff.isEmpty())
+        mCommands.append(new ChangeTileLayerCells(mMapDocument, tileLayer,
+                                                  other, diff));
+
+    return true;
+}
+
+/**
+ * Objects are matched by their ID. Reordering of the objects that exist in
+ * both versions is not supported.
+ */
+bool MapDiff::compareObjectGroup(ObjectGroup *objectGroup,
+                                 const ObjectGroup *other)
+{
+    QHash<int, MapObject*> currentObjects;
+    QHash<int, MapObject*> newObjects;
+
+    for (MapObject *mapObject : objectGroup->objects()) {
+        if (mapObject->id() == 0)
+            return false;
+        currentObjects.insert(mapObject->id(), mapObject);
+    }
+    for (MapObject *mapObject : other->objects()) {
+        if (mapObject->id() == 0)
+            return false;
+        newObjects.insert(mapObject->id(), mapObject);
+    }
+
+    // Removed objects disappear and new ones are appended, so this has to
+    // end up with the order of the new version
+    QList<int> order;
+    for (const MapObject *mapObject : objectGroup->objects())
+        if (newObjects.contains(mapObject->id()))
+            order.append(mapObject->id());
+    for (const MapObject *mapObject : other->objects())
+        if (!currentObjects.contains(mapObject->id()))
+            order.append(mapObject->id());
+
+    if (order.size() != other->objectCount())
+        return false;
+    for (int i = 0; i < order.size(); ++i)
+        if (order.at(i) != other->objectAt(i)->id())
+            return false;
+
+    for (MapObject *mapObject : objectGroup->objects())
+        if (!newObjects.contains(mapObject->id()))
+            mCommands.append(new RemoveMapObject(mMapDocument, mapObject));
+
+    for (MapObject *mapObject : objectGroup->objects()) {
+        const MapObject *newObject = newObjects.value(mapObject->id());
+        if (newObject && !sameObject(mapObject, newObject))
+            mCommands.append(new ReplaceMapObject(mMapDocument, mapObject,
+                                                  newObject->clone()));
+    }
+
+    for (const MapObject *mapObject : other->objects())
+        if (!currentObjects.contains(mapObject->id()))
+            mCommands.append(new AddMapObject(mMapDocument, objectGroup,
+                                              mapObject->clone()));
+
+    if (objectGroup->color() != other->color() ||
+            objectGroup->drawOrder() != other->drawOrder()) {
+        mCommands.append(new ChangeObjectGroupProperties(mMapDocument,
+                                                         objectGroup,
+                                                         other->color(),
+                                                         other->drawOrder()));
+    }
+
+    return true;
+}
+
+void MapDiff::compareImageLayer(ImageLayer *imageLayer,
+                                const ImageLayer *other)
+{
+    if (imageLayer->transparentColor() != other->transparentColor() ||
+            imageLayer->imageSource() != other->imageSource()) {
+        mCommands.append(new ChangeImageLayerProperties(mMapDocument,
+                                                        imageLayer,
+                                                        other->transparentColor(),
+                                                        other->imageSource()));
+    }
+}
+
+void MapDiff::compareProperties(const QString &kind, Object *object,
+                                const Properties &properties)
+{
+    if (object->properties() != properties)
+        mCommands.append(new ChangeProperties(mMapDocument, kind, object,
+                                              properties));
+}
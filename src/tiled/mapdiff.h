@@ -0,0 +1,83 @@
+/*
+ * mapdiff.h
+ * Copyright 2016, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TILED_INTERNAL_MAPDIFF_H
+#define TILED_INTERNAL_MAPDIFF_H
+
+#include "properties.h"
+
+#include <QCoreApplication>
+#include <QList>
+
+class QUndoCommand;
+
+namespace Tiled {
+
+class ImageLayer;
+class Layer;
+class Map;
+class Object;
+class ObjectGroup;
+class TileLayer;
+
+namespace Internal {
+
+class MapDocument;
+
+/**
+ * Compares the map of a document with another version of that map, like
+ * the one on disk after it was changed by another application, and creates
+ * the undo commands that turn the former into the latter.
+ *
+ * Only changes that can be applied without replacing the whole map are
+ * supported: changes to tiles, objects, properties and most attributes of
+ * layers and the map. Any other difference, like a change in the map size,
+ * the layer structure or the tilesets, makes compare() return false.
+ */
+class MapDiff
+{
+    Q_DECLARE_TR_FUNCTIONS(MapDiff)
+
+public:
+    explicit MapDiff(MapDocument *mapDocument);
+    ~MapDiff();
+
+    bool compare(Map *map);
+
+    QList<QUndoCommand*> takeCommands();
+
+private:
+    bool compareTilesets(Map *map);
+    bool compareLayer(int index, Layer *layer);
+    bool compareTileLayer(TileLayer *tileLayer, const TileLayer *other);
+    bool compareObjectGroup(ObjectGroup *objectGroup, const ObjectGroup *other);
+    void compareImageLayer(ImageLayer *imageLayer, const ImageLayer *other);
+    void compareProperties(const QString &kind, Object *object,
+                           const Properties &properties);
+
+    MapDocument *mMapDocument;
+    QList<QUndoCommand*> mCommands;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // TILED_INTERNAL_MAPDIFF_H
@@ -32,9 +32,11 @@
 #include "imagelayer.h"
 #include "isometricrenderer.h"
 #include "layermodel.h"
+#include "mapdiff.h"
 #include "mapobjectmodel.h"
 #include "map.h"
 #include "mapobject.h"
+#include "mapwriter.h"
 #include "movelayer.h"
 #include "movemapobject.h"
 #include "movemapobjecttogroup.h"
@@ -43,9 +45,11 @@
 #include "orthogonalrenderer.h"
 #include "painttilelayer.h"
 #include "pluginmanager.h"
+#include "preferences.h"
 #include "resizemap.h"
 #include "resizetilelayer.h"
 #include "rotatemapobject.h"
+#include "savejournal.h"
 #include "staggeredrenderer.h"
 #include "terrain.h"
 #include "terrainmodel.h"
@@ -53,10 +57,16 @@
 #include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "tmxmapformat.h"
+#include "undocommands.h"
 
 #include <QFileInfo>
+#include <QMutex>
 #include <QRect>
+#include <QScopedPointer>
 #include <QUndoStack>
+#include <QtConcurrent>
+
+#include <typeinfo>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -69,7 +79,10 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
     mRenderer(nullptr),
     mMapObjectModel(new MapObjectModel(this)),
     mTerrainModel(new TerrainModel(this, this)),
-    mUndoStack(new QUndoStack(this))
+    mUndoStack(new QUndoStack(this)),
+    mCleanIndexValid(true),
+    mSaveWatcher(nullptr),
+    mSaveSnapshot(nullptr)
 {
     createRenderer();
 
@@ -109,6 +122,9 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
 
     connect(mUndoStack, SIGNAL(cleanChanged(bool)), SIGNAL(modifiedChanged()));
 
+    connect(this, &MapDocument::regionChanged,
+            this, &MapDocument::onRegionChanged);
+
     // Register tileset references
     TilesetManager *tilesetManager = TilesetManager::instance();
     tilesetManager->addReferences(mMap->tilesets());
@@ -116,8 +132,16 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
 
 MapDocument::~MapDocument()
 {
-    // Unregister tileset references
+    // The snapshot being saved shares the tilesets of this map
     TilesetManager *tilesetManager = TilesetManager::instance();
+
+    if (mSaveWatcher) {
+        mSaveWatcher->waitForFinished();
+        delete mSaveSnapshot;
+        tilesetManager->endBackgroundSave();
+    }
+
+    // Unregister tileset references
     tilesetManager->removeReferences(mMap->tilesets());
 
     delete mRenderer;
@@ -131,29 +155,179 @@ bool MapDocument::save(QString *error)
 
 bool MapDocument::save(const QString &fileName, QString *error)
 {
+    waitForSave();
+
+    if (saveToJournal(fileName)) {
+        undoStack()->setClean();
+        emit saved();
+        return true;
+    }
+
     MapFormat *mapFormat = mWriterFormat;
 
     TmxMapFormat tmxMapFormat;
     if (!mapFormat)
         mapFormat = &tmxMapFormat;
 
-    if (!mapFormat->write(map(), fileName)) {
-        if (error)
-            *error = mapFormat->errorString();
-        return false;
+    {
+        QMutexLocker locker(mWriterFormat ? formatMutex() : nullptr);
+        if (!mapFormat->write(map(), fileName)) {
+            if (error)
+                *error = mapFormat->errorString();
+            return false;
+        }
     }
 
+    // The journal does not apply to the newly written file
+    SaveJournal::discard(fileName);
+    mUnsavedRegions.clear();
+
     undoStack()->setClean();
     setFileName(fileName);
     mLastSaved = QFileInfo(fileName).lastModified();
 
+    if (!mCleanIndexValid) {
+        mCleanIndexValid = true;
+        emit modifiedChanged();
+    }
+
     emit saved();
     return true;
 }
 
-MapDocument *MapDocument::load(const QString &fileName,
-                               MapFormat *mapFormat,
-                               QString *error)
+/**
+ * Writes the \a map to \a fileName. Runs on a worker thread, so it may not
+ * touch anything but the given map snapshot. Returns an error message, which
+ * is empty on success.
+ */
+static QString writeSnapshot(const Map *map, const QString &fileName,
+                             MapFormat *format, bool dtdEnabled)
+{
+    if (!format) {
+        MapWriter writer;
+        writer.setDtdEnabled(dtdEnabled);
+        if (!writer.writeMap(map, fileName))
+            return writer.errorString();
+        return QString();
+    }
+
+    QMutexLocker locker(MapDocument::formatMutex());
+    if (!format->write(map, fileName)) {
+        const QString error = format->errorString();
+        if (error.isEmpty())
+            return QCoreApplication::translate("MapDocument", "Failed to write %1").arg(fileName);
+        return error;
+    }
+    return QString();
+}
+
+void MapDocument::saveInBackground(const QString &fileName)
+{
+    waitForSave();
+
+    if (saveToJournal(fileName)) {
+        undoStack()->setClean();
+        emit saved();
+        return;
+    }
+
+    if (!canSaveInBackground()) {
+        QString error;
+        if (!save(fileName, &error))
+            emit saveFailed(error);
+        return;
+    }
+
+    // Copying the layers takes much less time than writing them
+    mSaveSnapshot = new Map(*mMap);
+    mSaveSnapshot->setNextObjectId(mMap->nextObjectId());
+    mSaveFileName = fileName;
+    mUnsavedRegions.clear();
+
+    // Marking the snapshot state as clean also prevents further changes from
+    // being merged into it. Until the save succeeded, the map still counts as
+    // modified.
+    mCleanIndexValid = false;
+    mUndoStack->setClean();
+
+    const Map *snapshot = mSaveSnapshot;
+    MapFormat *format = mWriterFormat;
+
+    // The TMX format is written using a MapWriter of its own, which does not
+    // need to be serialized with other writes
+    if (qobject_cast<TmxMapFormat*>(format))
+        format = nullptr;
+    const bool dtdEnabled = Preferences::instance()->dtdEnabled();
+
+    // The snapshot shares the tilesets, so they may not be reloaded while
+    // it is being written
+    TilesetManager::instance()->beginBackgroundSave();
+
+    mSaveWatcher = new QFutureWatcher<QString>(this);
+    connect(mSaveWatcher, &QFutureWatcherBase::finished,
+            this, &MapDocument::backgroundSaveFinished);
+    mSaveWatcher->setFuture(QtConcurrent::run(writeSnapshot, snapshot, fileName,
+                                              format, dtdEnabled));
+}
+
+void MapDocument::waitForSave()
+{
+    if (!mSaveWatcher)
+        return;
+
+    mSaveWatcher->waitForFinished();
+    backgroundSaveFinished();
+}
+
+QMutex *MapDocument::formatMutex()
+{
+    static QMutex mutex;
+    return &mutex;
+}
+
+void MapDocument::backgroundSaveFinished()
+{
+    if (!mSaveWatcher)
+        return;
+
+    const QString error = mSaveWatcher->result();
+
+    mSaveWatcher->disconnect(this);
+    mSaveWatcher->deleteLater();
+    mSaveWatcher = nullptr;
+
+    // Deleted here rather than on the worker thread because of its pixmaps
+    delete mSaveSnapshot;
+    mSaveSnapshot = nullptr;
+
+    TilesetManager::instance()->endBackgroundSave();
+
+    if (!error.isEmpty()) {
+        emit saveFailed(error);
+        return;
+    }
+
+    // The journal does not apply to the newly written file
+    SaveJournal::discard(mSaveFileName);
+
+    setFileName(mSaveFileName);
+    mLastSaved = QFileInfo(mSaveFileName).lastModified();
+
+    // The undo stack may have moved on, but its clean index refers to the
+    // state that was written
+    mCleanIndexValid = true;
+    emit modifiedChanged();
+    emit saved();
+}
+
+/**
+ * Reads the map from \a fileName. When no \a mapFormat is given, a plugin
+ * supporting the file is looked up, falling back to TMX, whose reader also
+ * replays the save journal.
+ */
+static Map *readMap(const QString &fileName,
+                    MapFormat *&mapFormat,
+                    QString *error)
 {
     TmxMapFormat tmxMapFormat;
 
@@ -178,11 +352,19 @@ MapDocument *MapDocument::load(const QString &fileName,
         errorString = tmxMapFormat.errorString();
     }
 
-    if (!map) {
-        if (error)
-            *error = errorString;
+    if (!map && error)
+        *error = errorString;
+
+    return map;
+}
+
+MapDocument *MapDocument::load(const QString &fileName,
+                               MapFormat *mapFormat,
+                               QString *error)
+{
+    Map *map = readMap(fileName, mapFormat, error);
+    if (!map)
         return nullptr;
-    }
 
     MapDocument *mapDocument = new MapDocument(map, fileName);
     if (mapFormat) {
@@ -193,6 +375,128 @@ MapDocument *MapDocument::load(const QString &fileName,
     return mapDocument;
 }
 
+/**
+ * Reads the map from disk again and applies only the differences with the
+ * current map, as a single undo command. This keeps the undo history and
+ * means only the changed parts of the map need to be redrawn.
+ *
+ * Returns false when the map could not be read or when it changed in a way
+ * that can't be applied incrementally, like a change of the map size or of
+ * the tilesets. The document should then be reloaded entirely.
+ */
+bool MapDocument::reloadIncrementally()
+{
+    waitForSave();
+
+    MapFormat *mapFormat = mReaderFormat;
+    QScopedPointer<Map> map(readMap(mFileName, mapFormat, nullptr));
+    if (!map)
+        return false;
+
+    MapDiff diff(this);
+    if (!diff.compare(map.data()))
+        return false;
+
+    const QList<QUndoCommand*> undoCommands = diff.takeCommands();
+    if (!undoCommands.isEmpty()) {
+        mUndoStack->beginMacro(tr("Reload Map"));
+        for (QUndoCommand *command : undoCommands)
+            mUndoStack->push(command);
+        mUndoStack->endMacro();
+    }
+
+    // The map now matches the file (including its journal) again
+    mUnsavedRegions.clear();
+    mUndoStack->setClean();
+    mLastSaved = QFileInfo(mFileName).lastModified();
+
+    if (!mCleanIndexValid) {
+        mCleanIndexValid = true;
+        emit modifiedChanged();
+    }
+
+    return true;
+}
+
+/**
+ * Returns whether the given \a command only changes tile layer data, in which
+ * case its changes can be written to the save journal.
+ */
+static bool onlyChangesTiles(const QUndoCommand *command)
+{
+    switch (command->id()) {
+    case Cmd_EraseTiles:
+    case Cmd_PaintTileLayer:
+        return true;
+    }
+
+    // Macros are plain QUndoCommand instances with child commands
+    if (typeid(*command) != typeid(QUndoCommand) || command->childCount() == 0)
+        return false;
+
+    for (int i = 0; i < command->childCount(); ++i)
+        if (!onlyChangesTiles(command->child(i)))
+            return false;
+
+    return true;
+}
+
+/**
+ * Returns whether the map can be written on a worker thread. This is not the
+ * case when it has embedded tilesets, since those may be changed while the
+ * save is in progress.
+ */
+bool MapDocument::canSaveInBackground() const
+{
+    for (const SharedTileset &tileset : mMap->tilesets())
+        if (!tileset->isExternal())
+            return false;
+
+    return true;
+}
+
+/**
+ * Tries to save the changes made since the last save by appending the
+ * changed tiles to the save journal. This is only possible when saving to
+ * the same TMX file and when all changes since then affected only tile data.
+ * The journal is replayed by MapReader, so other formats don't support it.
+ *
+ * Returns false when the whole map needs to be written instead.
+ */
+bool MapDocument::saveToJournal(const QString &fileName)
+{
+    if (!Preferences::instance()->saveJournalEnabled())
+        return false;
+    if (mWriterFormat && !qobject_cast<TmxMapFormat*>(mWriterFormat))
+        return false;
+    if (!mCleanIndexValid)
+        return false;
+    if (fileName != mFileName || !QFileInfo::exists(fileName))
+        return false;
+
+    // The map was changed by the reader (for example by replaying a journal)
+    const int cleanIndex = mUndoStack->cleanIndex();
+    if (cleanIndex == -1)
+        return false;
+
+    const int first = qMin(cleanIndex, mUndoStack->index());
+    const int last = qMax(cleanIndex, mUndoStack->index());
+    for (int i = first; i < last; ++i)
+        if (!onlyChangesTiles(mUndoStack->command(i)))
+            return false;
+
+    // Compact the journal by writing the whole map once it grows too large
+    const qint64 mapSize = QFileInfo(fileName).size();
+    if (SaveJournal::size(fileName) > mapSize / 4)
+        return false;
+
+    if (!SaveJournal::append(fileName, mMap, mUnsavedRegions))
+        return false;
+
+    mUnsavedRegions.clear();
+    return true;
+}
+
 void MapDocument::setFileName(const QString &fileName)
 {
     if (mFileName == fileName)
@@ -251,7 +555,7 @@ QString MapDocument::displayName() const
  */
 bool MapDocument::isModified() const
 {
-    return !mUndoStack->isClean();
+    return !mCleanIndexValid || !mUndoStack->isClean();
 }
 
 void MapDocument::setCurrentLayerIndex(int index)
@@ -902,6 +1206,11 @@ void MapDocument::onLayerRemoved(int index)
         emit currentLayerIndexChanged(mCurrentLayerIndex);
 }
 
+void MapDocument::onRegionChanged(const QRegion &region, Layer *layer)
+{
+    mUnsavedRegions[layer] |= region;
+}
+
 void MapDocument::onTerrainRemoved(Terrain *terrain)
 {
     if (terrain == mCurrentObject)
@@ -1041,4 +1350,7 @@ void MapDocument::createRenderer()
         mRenderer = new OrthogonalRenderer(mMap);
         break;
     }
+
+    // Tiles covering only a pixel or two are drawn using their average color
+    mRenderer->setFlatColorTileSize(2);
 }
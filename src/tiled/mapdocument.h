@@ -28,6 +28,8 @@
 #include "tileset.h"
 
 #include <QDateTime>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QPointer>
@@ -35,6 +37,7 @@
 #include <QString>
 
 class QModelIndex;
+class QMutex;
 class QPoint;
 class QRect;
 class QSize;
@@ -100,6 +103,31 @@ public:
      */
     bool save(const QString &fileName, QString *error = nullptr);
 
+    /**
+     * Saves the map to the file at \a fileName like save(), but writes the
+     * file on a worker thread so that the map can be edited in the meantime.
+     * Emits saved() or saveFailed() when done.
+     *
+     * The write operates on a snapshot of the map, which shares its tilesets
+     * with the document. Maps with embedded tilesets, which can be edited
+     * while the save is in progress, are therefore saved synchronously.
+     */
+    void saveInBackground(const QString &fileName);
+
+    bool isSaving() const { return mSaveWatcher != nullptr; }
+
+    /**
+     * Blocks until a save running in the background has finished.
+     */
+    void waitForSave();
+
+    /**
+     * Map formats are not safe to use from multiple threads. This mutex needs
+     * to be held while writing through a format that may also be used by a
+     * background save.
+     */
+    static QMutex *formatMutex();
+
     /**
      * Loads a map and returns a MapDocument instance on success. Returns null
      * on error and sets the \a error message.
@@ -108,6 +136,8 @@ public:
                              MapFormat *mapFormat = nullptr,
                              QString *error = nullptr);
 
+    bool reloadIncrementally();
+
     QString fileName() const { return mFileName; }
 
     QString lastExportFileName() const;
@@ -285,6 +315,7 @@ signals:
     void modifiedChanged();
 
     void saved();
+    void saveFailed(const QString &error);
 
     /**
      * Emitted when the selected tile region changes. Sends the currently
@@ -389,9 +420,14 @@ private slots:
     void onLayerAboutToBeRemoved(int index);
     void onLayerRemoved(int index);
 
+    void onRegionChanged(const QRegion &region, Layer *layer);
     void onTerrainRemoved(Terrain *terrain);
 
+    void backgroundSaveFinished();
+
 private:
+    bool canSaveInBackground() const;
+    bool saveToJournal(const QString &fileName);
     void setFileName(const QString &fileName);
     void deselectObjects(const QList<MapObject*> &objects);
 
@@ -417,6 +453,12 @@ private:
     TerrainModel *mTerrainModel;
     QUndoStack *mUndoStack;
     QDateTime mLastSaved;
+    QHash<Layer*, QRegion> mUnsavedRegions;   /**< Changed tiles since last save. */
+    bool mCleanIndexValid;                    /**< Whether the clean undo index matches the file. */
+
+    QFutureWatcher<QString> *mSaveWatcher;
+    Map *mSaveSnapshot;
+    QString mSaveFileName;
 };
 
 
@@ -51,11 +51,24 @@ MapObjectItem::MapObjectItem(MapObject *object, MapDocument *mapDocument,
                              ObjectGroupItem *parent):
     QGraphicsItem(parent),
     mObject(object),
-    mMapDocument(mapDocument)
+    mMapDocument(mapDocument),
+    mGroupItem(nullptr)
 {
+    if (parent && parent->drawsObjects()) {
+        // The object is drawn by the object group item
+        setFlag(QGraphicsItem::ItemHasNoContents);
+        mGroupItem = parent;
+    }
+
     syncWithMapObject();
 }
 
+MapObjectItem::~MapObjectItem()
+{
+    if (mGroupItem)
+        mGroupItem->removeObjectItem(this);
+}
+
 void MapObjectItem::syncWithMapObject()
 {
     const QColor color = objectColor(mObject);
@@ -94,6 +107,9 @@ void MapObjectItem::syncWithMapObject()
     }
 
     setVisible(mObject->isVisible());
+
+    if (mGroupItem)
+        mGroupItem->syncObjectItem(this);
 }
 
 QRectF MapObjectItem::boundingRect() const
@@ -134,13 +150,24 @@ void MapObjectItem::setPolygon(const QPolygonF &polygon)
     syncWithMapObject();
 }
 
+QVariant MapObjectItem::itemChange(GraphicsItemChange change,
+                                   const QVariant &value)
+{
+    // Changes to the drawing order or visibility need a repaint from the
+    // object group item.
+    if (mGroupItem && (change == ItemZValueHasChanged ||
+                       change == ItemVisibleHasChanged))
+        mGroupItem->syncObjectItem(this);
+
+    return QGraphicsItem::itemChange(change, value);
+}
+
 QColor MapObjectItem::objectColor(const MapObject *object)
 {
     // See if this object type has a color associated with it
-    for (const ObjectType &type : Preferences::instance()->objectTypes()) {
-        if (type.name.compare(object->type(), Qt::CaseInsensitive) == 0)
-            return type.color;
-    }
+    const Preferences *prefs = Preferences::instance();
+    if (const ObjectType *type = prefs->objectType(object->type(), Qt::CaseInsensitive))
+        return type->color;
 
     // If not, get color from object group
     const ObjectGroup *objectGroup = object->objectGroup();
@@ -53,6 +53,7 @@ public:
      */
     MapObjectItem(MapObject *object, MapDocument *mapDocument,
                   ObjectGroupItem *parent = nullptr);
+    ~MapObjectItem();
 
     enum { Type = UserType + 1 };
     int type() const override { return Type; }
@@ -60,6 +61,8 @@ public:
     MapObject *mapObject() const
     { return mObject; }
 
+    QColor color() const { return mColor; }
+
     /**
      * Should be called when the map object this item refers to was changed.
      */
@@ -92,13 +95,19 @@ public:
      */
     static QColor objectColor(const MapObject *object);
 
+protected:
+    QVariant itemChange(GraphicsItemChange change,
+                        const QVariant &value) override;
+
 private:
     MapDocument *mapDocument() const { return mMapDocument; }
-    QColor color() const { return mColor; }
 
     MapObject *mObject;
     MapDocument *mMapDocument;
 
+    /** The object group item drawing this object, if any. */
+    ObjectGroupItem *mGroupItem;
+
     /** Bounding rect cached, for adapting to geometry change correctly. */
     QRectF mBoundingRect;
     QString mName;      // Copy of the name, so we know when it changes
@@ -222,7 +222,7 @@ QModelIndex MapObjectModel::index(ObjectGroup *og) const
 
 QModelIndex MapObjectModel::index(MapObject *o, int column) const
 {
-    const int row = o->objectGroup()->objects().indexOf(o);
+    const int row = o->objectGroup()->indexOf(o);
     Q_ASSERT(mObjects[o]);
     return createIndex(row, column, mObjects[o]);
 }
@@ -363,7 +363,7 @@ int MapObjectModel::removeObject(ObjectGroup *og, MapObject *o)
     QList<MapObject*> objects;
     objects << o;
 
-    const int row = og->objects().indexOf(o);
+    const int row = og->indexOf(o);
     beginRemoveRows(index(og), row, row);
     og->removeObjectAt(row);
     delete mObjects.take(o);
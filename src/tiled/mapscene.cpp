@@ -50,6 +50,7 @@
 #include <QKeyEvent>
 #include <QPalette>
 
+#include <algorithm>
 #include <cmath>
 
 using namespace Tiled;
@@ -78,6 +79,8 @@ MapScene::MapScene(QObject *parent):
             this, SLOT(tilesetChanged(Tileset*)));
     connect(tilesetManager, SIGNAL(repaintTileset(Tileset*)),
             this, SLOT(tilesetChanged(Tileset*)));
+    connect(tilesetManager, &TilesetManager::tileImagesChanged,
+            this, &MapScene::tileImagesChanged);
 
     Preferences *prefs = Preferences::instance();
     connect(prefs, SIGNAL(showGridChanged(bool)), SLOT(setGridVisible(bool)));
@@ -236,7 +239,7 @@ QGraphicsItem *MapScene::createLayerItem(Layer *layer)
         layerItem = new TileLayerItem(tl, mMapDocument);
     } else if (ObjectGroup *og = layer->asObjectGroup()) {
         const ObjectGroup::DrawOrder drawOrder = og->drawOrder();
-        ObjectGroupItem *ogItem = new ObjectGroupItem(og);
+        ObjectGroupItem *ogItem = new ObjectGroupItem(og, mMapDocument);
         int objectIndex = 0;
         for (MapObject *object : og->objects()) {
             MapObjectItem *item = new MapObjectItem(object, mMapDocument,
@@ -260,6 +263,60 @@ QGraphicsItem *MapScene::createLayerItem(Layer *layer)
     return layerItem;
 }
 
+QList<MapObjectItem*> MapScene::objectItemsAt(const QPointF &pos) const
+{
+    QList<MapObjectItem*> items = objectItemsNear(QRectF(pos, QSizeF(1, 1)));
+
+    auto missed = [pos] (const MapObjectItem *item) {
+        return !item->contains(item->mapFromScene(pos));
+    };
+    items.erase(std::remove_if(items.begin(), items.end(), missed), items.end());
+
+    std::reverse(items.begin(), items.end());
+    return items;
+}
+
+QList<MapObjectItem*> MapScene::objectItemsIn(const QPainterPath &area,
+                                              Qt::SortOrder order) const
+{
+    QList<MapObjectItem*> items = objectItemsNear(area.boundingRect());
+
+    auto missed = [&area] (const MapObjectItem *item) {
+        return !item->collidesWithPath(item->mapFromScene(area));
+    };
+    items.erase(std::remove_if(items.begin(), items.end(), missed), items.end());
+
+    if (order == Qt::DescendingOrder)
+        std::reverse(items.begin(), items.end());
+    return items;
+}
+
+/**
+ * Returns the visible map object items of which the bounds intersect with
+ * \a sceneRect, bottom-most first. The map object items are not in the scene
+ * index, so they are looked up in the grids of the object group items.
+ */
+QList<MapObjectItem*> MapScene::objectItemsNear(const QRectF &sceneRect) const
+{
+    QList<MapObjectItem*> result;
+
+    // The layer items are stacked in the order of the layers
+    for (QGraphicsItem *layerItem : mLayerItems) {
+        ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(layerItem);
+        if (!ogItem || !ogItem->isVisible())
+            continue;
+
+        QVector<MapObjectItem*> items = ogItem->objectItemsIn(ogItem->mapRectFromScene(sceneRect));
+        ogItem->sortInDrawingOrder(items);
+
+        for (MapObjectItem *item : items)
+            if (item->isVisible())
+                result.append(item);
+    }
+
+    return result;
+}
+
 void MapScene::updateDefaultBackgroundColor()
 {
     mDefaultBackgroundColor = QGuiApplication::palette().dark().color();
@@ -403,6 +460,38 @@ void MapScene::tilesetChanged(Tileset *tileset)
         update();
 }
 
+/**
+ * Repaints only the parts of the map that use any of the given \a tiles.
+ */
+void MapScene::tileImagesChanged(const QList<Tile*> &tiles)
+{
+    if (!mMapDocument)
+        return;
+
+    const Map *map = mMapDocument->map();
+    if (!contains(map->tilesets(), tiles.first()->tileset()))
+        return;
+
+    const QSet<Tile*> changedTiles = tiles.toSet();
+
+    for (Layer *layer : map->layers()) {
+        if (TileLayer *tileLayer = layer->asTileLayer()) {
+            const QRegion region = tileLayer->region([&] (const Cell &cell) {
+                return changedTiles.contains(cell.tile);
+            });
+
+            if (!region.isEmpty())
+                repaintRegion(region, tileLayer);
+        }
+    }
+
+    // Syncing also updates the bounds, which depend on the tile image size,
+    // and makes the object group item repaint the object
+    for (MapObjectItem *item : mObjectItems)
+        if (changedTiles.contains(item->mapObject()->cell().tile))
+            item->syncWithMapObject();
+}
+
 void MapScene::tileLayerDrawMarginsChanged(TileLayer *tileLayer)
 {
     const int index = mMapDocument->map()->layers().indexOf(tileLayer);
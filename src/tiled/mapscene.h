@@ -27,6 +27,7 @@
 #include <QColor>
 #include <QGraphicsScene>
 #include <QMap>
+#include <QPainterPath>
 #include <QSet>
 
 namespace Tiled {
@@ -99,6 +100,19 @@ public:
     MapObjectItem *itemForObject(MapObject *object) const
     { return mObjectItems.value(object); }
 
+    /**
+     * Returns the visible map object items at the given scene position,
+     * topmost first.
+     */
+    QList<MapObjectItem*> objectItemsAt(const QPointF &pos) const;
+
+    /**
+     * Returns the visible map object items whose shape intersects with the
+     * given \a area in scene coordinates.
+     */
+    QList<MapObjectItem*> objectItemsIn(const QPainterPath &area,
+                                        Qt::SortOrder order = Qt::DescendingOrder) const;
+
     /**
      * Enables the selected tool at this map scene.
      * Therefore it tells that tool, that this is the active map scene.
@@ -156,6 +170,7 @@ private slots:
 
     void mapChanged();
     void tilesetChanged(Tileset *tileset);
+    void tileImagesChanged(const QList<Tile*> &tiles);
     void tileLayerDrawMarginsChanged(TileLayer *tileLayer);
 
     void layerAdded(int index);
@@ -181,6 +196,8 @@ private slots:
 private:
     QGraphicsItem *createLayerItem(Layer *layer);
 
+    QList<MapObjectItem*> objectItemsNear(const QRectF &sceneRect) const;
+
     void updateDefaultBackgroundColor();
     void updateSceneRect();
     void updateCurrentLayerHighlight();
@@ -21,6 +21,7 @@
 
 #include "minimap.h"
 
+#include "containerhelpers.h"
 #include "documentmanager.h"
 #include "imagelayer.h"
 #include "map.h"
@@ -31,14 +32,15 @@
 #include "mapview.h"
 #include "objectgroup.h"
 #include "preferences.h"
+#include "tile.h"
 #include "tilelayer.h"
+#include "tilesetmanager.h"
 #include "zoomable.h"
 
 #include <QCursor>
 #include <QPainter>
 #include <QResizeEvent>
 #include <QScrollBar>
-#include <QUndoStack>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -49,6 +51,7 @@ MiniMap::MiniMap(QWidget *parent)
     , mDragging(false)
     , mMouseMoveCursorState(false)
     , mRedrawMapImage(false)
+    , mMapImageScale(1)
     , mRenderFlags(DrawTiles | DrawObjects | DrawImages | IgnoreInvisibleLayer)
 {
     setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
@@ -60,6 +63,9 @@ MiniMap::MiniMap(QWidget *parent)
     mMapImageUpdateTimer.setSingleShot(true);
     connect(&mMapImageUpdateTimer, SIGNAL(timeout()),
             SLOT(redrawTimeout()));
+
+    connect(TilesetManager::instance(), &TilesetManager::tileImagesChanged,
+            this, &MiniMap::tileImagesChanged);
 }
 
 void MiniMap::setMapDocument(MapDocument *map)
@@ -78,9 +84,37 @@ void MiniMap::setMapDocument(MapDocument *map)
 
     mMapDocument = map;
 
+    mObjectBounds.clear();
+
     if (mMapDocument) {
-        connect(mMapDocument->undoStack(), SIGNAL(indexChanged(int)),
-                this, SLOT(scheduleMapImageUpdate()));
+        // Changes to tiles and objects only cause the affected area to be
+        // redrawn, while anything else redraws the whole minimap.
+        connect(mMapDocument, &MapDocument::regionChanged,
+                this, &MiniMap::regionChanged);
+        connect(mMapDocument, &MapDocument::objectsAdded,
+                this, &MiniMap::objectsChanged);
+        connect(mMapDocument, &MapDocument::objectsChanged,
+                this, &MiniMap::objectsChanged);
+        connect(mMapDocument, &MapDocument::objectsTypeChanged,
+                this, &MiniMap::objectsChanged);
+        connect(mMapDocument, &MapDocument::objectsRemoved,
+                this, &MiniMap::objectsRemoved);
+        connect(mMapDocument, &MapDocument::objectsIndexChanged,
+                this, &MiniMap::objectsIndexChanged);
+
+        connect(mMapDocument, SIGNAL(mapChanged()), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(layerAdded(int)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(layerRemoved(int)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(layerChanged(int)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(objectGroupChanged(ObjectGroup*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(imageLayerChanged(ImageLayer*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tilesetAdded(int,Tileset*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tilesetRemoved(Tileset*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tilesetReplaced(int,Tileset*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tilesetTileOffsetChanged(Tileset*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tilesetChanged(Tileset*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tileImageSourceChanged(Tile*)), SLOT(scheduleMapImageUpdate()));
+        connect(mMapDocument, SIGNAL(tileLayerDrawMarginsChanged(TileLayer*)), SLOT(scheduleMapImageUpdate()));
 
         if (MapView *mapView = dm->viewForDocument(mMapDocument)) {
             connect(mapView->horizontalScrollBar(), SIGNAL(valueChanged(int)), SLOT(update()));
@@ -99,6 +133,20 @@ QSize MiniMap::sizeHint() const
 
 void MiniMap::scheduleMapImageUpdate()
 {
+    mRedrawMapImage = true;
+    mMapImageUpdateTimer.start(100);
+}
+
+/**
+ * Schedules a redraw of the given \a rect (in map pixels) of the minimap
+ * image.
+ */
+void MiniMap::scheduleRectUpdate(const QRectF &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    mDirtyRect |= rect;
     mMapImageUpdateTimer.start(100);
 }
 
@@ -109,6 +157,10 @@ void MiniMap::paintEvent(QPaintEvent *pe)
     if (mRedrawMapImage) {
         renderMapToImage();
         mRedrawMapImage = false;
+        mDirtyRect = QRectF();
+    } else if (!mDirtyRect.isEmpty()) {
+        renderMapRect(mDirtyRect);
+        mDirtyRect = QRectF();
     }
 
     if (mMapImage.isNull() || mImageRect.isEmpty())
@@ -170,6 +222,8 @@ static bool objectLessThan(const MapObject *a, const MapObject *b)
 
 void MiniMap::renderMapToImage()
 {
+    mObjectBounds.clear();
+
     if (!mMapDocument) {
         mMapImage = QImage();
         return;
@@ -202,27 +256,68 @@ void MiniMap::renderMapToImage()
     if (imageSize.isEmpty())
         return;
 
+    mMapImageScale = scale;
+    mMapImageMargins = margins;
+
+    mMapImage.fill(Qt::transparent);
+    renderMapRect(QRectF());
+}
+
+/**
+ * Renders the given \a rect (in map pixels) of the map to the minimap image,
+ * using the scale and margins determined by the last full render. A null
+ * \a rect renders the whole map.
+ */
+void MiniMap::renderMapRect(const QRectF &rect)
+{
+    if (!mMapDocument || mMapImage.isNull())
+        return;
+
+    MapRenderer *renderer = mMapDocument->renderer();
+
     bool drawObjects = mRenderFlags.testFlag(DrawObjects);
     bool drawTiles = mRenderFlags.testFlag(DrawTiles);
     bool drawImages = mRenderFlags.testFlag(DrawImages);
     bool drawTileGrid = mRenderFlags.testFlag(DrawGrid);
     bool visibleLayersOnly = mRenderFlags.testFlag(IgnoreInvisibleLayer);
 
+    QTransform transform = QTransform::fromScale(mMapImageScale, mMapImageScale);
+    transform.translate(mMapImageMargins.left(), mMapImageMargins.top());
+
+    QPainter painter(&mMapImage);
+    painter.setRenderHints(QPainter::SmoothPixmapTransform);
+
+    QRectF exposed;
+
+    if (!rect.isNull()) {
+        // Redraw whole pixels of the image, with some room for smoothing
+        const QRect imageRect = transform.mapRect(rect).toAlignedRect()
+                .adjusted(-1, -1, 1, 1) & mMapImage.rect();
+        if (imageRect.isEmpty())
+            return;
+
+        painter.setClipRect(imageRect);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(imageRect, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+        exposed = transform.inverted().mapRect(QRectF(imageRect));
+    }
+
     // Remember the current render flags
     const Tiled::RenderFlags renderFlags = renderer->flags();
     renderer->setFlag(ShowTileObjectOutlines, false);
 
-    mMapImage.fill(Qt::transparent);
-    QPainter painter(&mMapImage);
-    painter.setRenderHints(QPainter::SmoothPixmapTransform);
-    painter.setTransform(QTransform::fromScale(scale, scale));
-    painter.translate(margins.left(), margins.top());
-    renderer->setPainterScale(scale);
+    painter.setTransform(transform);
+    renderer->setPainterScale(mMapImageScale);
 
     foreach (const Layer *layer, mMapDocument->map()->layers()) {
         if (visibleLayersOnly && !layer->isVisible())
             continue;
 
+        const QRectF layerExposed = exposed.isNull() ? exposed
+                                                     : exposed.translated(-layer->offset());
+
         painter.setOpacity(layer->opacity());
         painter.translate(layer->offset());
 
@@ -231,32 +326,44 @@ void MiniMap::renderMapToImage()
         const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer);
 
         if (tileLayer && drawTiles) {
-            renderer->drawTileLayer(&painter, tileLayer);
+            renderer->drawTileLayer(&painter, tileLayer, layerExposed);
         } else if (objGroup && drawObjects) {
-            QList<MapObject*> objects = objGroup->objects();
+            QList<MapObject*> objects;
+
+            for (MapObject *object : objGroup->objects()) {
+                if (!object->isVisible())
+                    continue;
+
+                // Bounds are cached, so partial redraws don't need to
+                // compute them for every object
+                auto bounds = mObjectBounds.find(object);
+                if (bounds == mObjectBounds.end())
+                    bounds = mObjectBounds.insert(object, objectBounds(object));
+
+                if (exposed.isNull() || bounds.value().intersects(exposed))
+                    objects.append(object);
+            }
 
             if (objGroup->drawOrder() == ObjectGroup::TopDownOrder)
                 qStableSort(objects.begin(), objects.end(), objectLessThan);
 
             foreach (const MapObject *object, objects) {
-                if (object->isVisible()) {
-                    if (object->rotation() != qreal(0)) {
-                        QPointF origin = renderer->pixelToScreenCoords(object->position());
-                        painter.save();
-                        painter.translate(origin);
-                        painter.rotate(object->rotation());
-                        painter.translate(-origin);
-                    }
-
-                    const QColor color = MapObjectItem::objectColor(object);
-                    renderer->drawMapObject(&painter, object, color);
-
-                    if (object->rotation() != qreal(0))
-                        painter.restore();
+                if (object->rotation() != qreal(0)) {
+                    QPointF origin = renderer->pixelToScreenCoords(object->position());
+                    painter.save();
+                    painter.translate(origin);
+                    painter.rotate(object->rotation());
+                    painter.translate(-origin);
                 }
+
+                const QColor color = MapObjectItem::objectColor(object);
+                renderer->drawMapObject(&painter, object, color);
+
+                if (object->rotation() != qreal(0))
+                    painter.restore();
             }
         } else if (imageLayer && drawImages) {
-            renderer->drawImageLayer(&painter, imageLayer);
+            renderer->drawImageLayer(&painter, imageLayer, layerExposed);
         }
 
         painter.translate(-layer->offset());
@@ -264,13 +371,122 @@ void MiniMap::renderMapToImage()
 
     if (drawTileGrid) {
         Preferences *prefs = Preferences::instance();
-        renderer->drawGrid(&painter, QRectF(QPointF(), renderer->mapSize()),
+        const QRectF mapRect(QPointF(), renderer->mapSize());
+        renderer->drawGrid(&painter,
+                           exposed.isNull() ? mapRect : exposed & mapRect,
                            prefs->gridColor());
     }
 
     renderer->setFlags(renderFlags);
 }
 
+/**
+ * Returns the area covered by the given \a object in map pixels, including
+ * its rotation and the offset of its object group.
+ */
+QRectF MiniMap::objectBounds(const MapObject *object) const
+{
+    MapRenderer *renderer = mMapDocument->renderer();
+    QRectF bounds = renderer->boundingRect(object);
+
+    if (object->rotation() != qreal(0)) {
+        const QPointF origin = renderer->pixelToScreenCoords(object->position());
+        QTransform transform;
+        transform.translate(origin.x(), origin.y());
+        transform.rotate(object->rotation());
+        transform.translate(-origin.x(), -origin.y());
+        bounds = transform.mapRect(bounds);
+    }
+
+    if (const ObjectGroup *objectGroup = object->objectGroup())
+        bounds.translate(objectGroup->offset());
+
+    // Leave some room for the outline
+    return bounds.adjusted(-2, -2, 2, 2);
+}
+
+/**
+ * Updates the cached bounds of the given \a object. Returns the area that
+ * needs to be redrawn, which includes both its previous and its new bounds.
+ */
+QRectF MiniMap::updateObjectBounds(const MapObject *object)
+{
+    const QRectF bounds = objectBounds(object);
+    const QRectF previousBounds = mObjectBounds.value(object);
+    mObjectBounds.insert(object, bounds);
+    return bounds | previousBounds;
+}
+
+void MiniMap::regionChanged(const QRegion &region, Layer *layer)
+{
+    MapRenderer *renderer = mMapDocument->renderer();
+    QRectF rect = renderer->boundingRect(region.boundingRect());
+
+    if (TileLayer *tileLayer = layer->asTileLayer()) {
+        // Tiles may extend beyond their cell
+        const QMargins drawMargins = tileLayer->drawMargins();
+        rect.adjust(-drawMargins.left(), -drawMargins.top(),
+                    drawMargins.right(), drawMargins.bottom());
+    }
+
+    scheduleRectUpdate(rect.translated(layer->offset()));
+}
+
+void MiniMap::objectsChanged(const QList<MapObject*> &objects)
+{
+    QRectF rect;
+
+    for (const MapObject *object : objects)
+        rect |= updateObjectBounds(object);
+
+    scheduleRectUpdate(rect);
+}
+
+void MiniMap::objectsRemoved(const QList<MapObject*> &objects)
+{
+    QRectF rect;
+
+    for (const MapObject *object : objects)
+        rect |= mObjectBounds.take(object);
+
+    scheduleRectUpdate(rect);
+}
+
+void MiniMap::objectsIndexChanged(ObjectGroup *objectGroup, int first, int last)
+{
+    objectsChanged(objectGroup->objects().mid(first, last - first + 1));
+}
+
+/**
+ * Redraws only the areas of the map that use any of the given \a tiles.
+ */
+void MiniMap::tileImagesChanged(const QList<Tile*> &tiles)
+{
+    if (!mMapDocument)
+        return;
+
+    const Map *map = mMapDocument->map();
+    if (!contains(map->tilesets(), tiles.first()->tileset()))
+        return;
+
+    const QSet<Tile*> changedTiles = tiles.toSet();
+
+    for (Layer *layer : map->layers()) {
+        if (TileLayer *tileLayer = layer->asTileLayer()) {
+            const QRegion region = tileLayer->region([&] (const Cell &cell) {
+                return changedTiles.contains(cell.tile);
+            });
+
+            if (!region.isEmpty())
+                regionChanged(region, tileLayer);
+        } else if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
+            for (const MapObject *object : objectGroup->objects())
+                if (changedTiles.contains(object->cell().tile))
+                    scheduleRectUpdate(updateObjectBounds(object));
+        }
+    }
+}
+
 void MiniMap::centerViewOnLocalPixel(QPoint centerPos, int delta)
 {
     MapView *mapView = DocumentManager::instance()->currentMapView();
@@ -285,7 +501,6 @@ void MiniMap::centerViewOnLocalPixel(QPoint centerPos, int delta)
 
 void MiniMap::redrawTimeout()
 {
-    mRedrawMapImage = true;
     update();
 }
 
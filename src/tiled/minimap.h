@@ -23,10 +23,17 @@
 #define MINIMAP_H
 
 #include <QFrame>
+#include <QHash>
 #include <QImage>
 #include <QTimer>
 
 namespace Tiled {
+
+class Layer;
+class MapObject;
+class ObjectGroup;
+class Tile;
+
 namespace Internal {
 
 class MapDocument;
@@ -69,6 +76,12 @@ protected:
 private slots:
     void redrawTimeout();
 
+    void regionChanged(const QRegion &region, Layer *layer);
+    void objectsChanged(const QList<MapObject*> &objects);
+    void objectsRemoved(const QList<MapObject*> &objects);
+    void objectsIndexChanged(ObjectGroup *objectGroup, int first, int last);
+    void tileImagesChanged(const QList<Tile*> &tiles);
+
 private:
     MapDocument *mMapDocument;
     QImage mMapImage;
@@ -78,12 +91,20 @@ private:
     QPoint mDragOffset;
     bool mMouseMoveCursorState;
     bool mRedrawMapImage;
+    QRectF mDirtyRect;                  /**< In map pixels, excluding margins. */
+    qreal mMapImageScale;
+    QMargins mMapImageMargins;
+    QHash<const MapObject*, QRectF> mObjectBounds;
     MiniMapRenderFlags mRenderFlags;
 
     QRect viewportRect() const;
     QPointF mapToScene(QPoint p) const;
     void updateImageRect();
     void renderMapToImage();
+    void renderMapRect(const QRectF &rect);
+    void scheduleRectUpdate(const QRectF &rect);
+    QRectF objectBounds(const MapObject *object) const;
+    QRectF updateObjectBounds(const MapObject *object);
     void centerViewOnLocalPixel(QPoint centerPos, int delta = 0);
 };
 
@@ -21,29 +21,255 @@
 #include "objectgroupitem.h"
 
 #include "map.h"
+#include "mapdocument.h"
+#include "mapobject.h"
 #include "mapobjectitem.h"
+#include "maprenderer.h"
+#include "mapview.h"
 #include "objectgroup.h"
+#include "zoomable.h"
+
+#include <QPainter>
+#include <QSet>
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
-ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup):
-    mObjectGroup(objectGroup)
+static const qreal GridCellSize = 512;
+
+// Objects covering more grid cells are kept in a separate list
+static const int MaximumGridCells = 64;
+
+static int gridCoordinate(qreal value)
 {
-    // Since we don't do any painting, we can spare us the call to paint()
-    setFlag(QGraphicsItem::ItemHasNoContents);
+    return int(std::floor(value / GridCellSize));
+}
+
+static quint64 gridKey(int x, int y)
+{
+    return quint64(quint32(x)) << 32 | quint32(y);
+}
+
+ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup,
+                                 MapDocument *mapDocument):
+    mObjectGroup(objectGroup),
+    mMapDocument(mapDocument)
+{
+    if (mMapDocument) {
+        // The exposed rect is used to look up the objects to draw
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+        // The bounding rect contains all map object items, which keeps them
+        // out of the scene index. They are looked up in the grid instead.
+#if QT_VERSION >= 0x050400
+        setFlag(QGraphicsItem::ItemContainsChildrenInShape);
+#else
+        setFlag(QGraphicsItem::ItemClipsChildrenToShape);
+#endif
+    } else {
+        // Since we don't do any painting, we can spare us the call to paint()
+        setFlag(QGraphicsItem::ItemHasNoContents);
+    }
 
     setOpacity(objectGroup->opacity());
     setPos(objectGroup->offset());
 }
 
+ObjectGroupItem::~ObjectGroupItem()
+{
+    // Delete the object items while the grid still exists, since they
+    // remove themselves from it.
+    qDeleteAll(childItems());
+}
+
+/**
+ * Updates the position of the given map object \a item in the grid and
+ * schedules a repaint of its old and new area. Does nothing when this item
+ * does not draw its objects.
+ */
+void ObjectGroupItem::syncObjectItem(MapObjectItem *item)
+{
+    if (!drawsObjects())
+        return;
+
+    const QRectF bounds = item->mapRectToParent(item->boundingRect());
+
+    auto it = mObjectBounds.find(item);
+    if (it == mObjectBounds.end()) {
+        mObjectBounds.insert(item, bounds);
+        addToGrid(item, bounds);
+    } else if (it.value() != bounds) {
+        update(it.value());
+        removeFromGrid(item, it.value());
+        it.value() = bounds;
+        addToGrid(item, bounds);
+    }
+
+    if (!mBoundingRect.contains(bounds)) {
+        prepareGeometryChange();
+        mBoundingRect |= bounds;
+    }
+
+    update(bounds);
+}
+
+void ObjectGroupItem::removeObjectItem(MapObjectItem *item)
+{
+    auto it = mObjectBounds.find(item);
+    if (it == mObjectBounds.end())
+        return;
+
+    update(it.value());
+    removeFromGrid(item, it.value());
+    mObjectBounds.erase(it);
+}
+
 QRectF ObjectGroupItem::boundingRect() const
 {
-    return QRectF();
+    return mBoundingRect;
+}
+
+void ObjectGroupItem::paint(QPainter *painter,
+                            const QStyleOptionGraphicsItem *option,
+                            QWidget *widget)
+{
+    if (!drawsObjects())
+        return;
+
+    QVector<MapObjectItem*> items = objectItemsIn(option->exposedRect);
+    sortInDrawingOrder(items);
+
+    const qreal scale = static_cast<MapView*>(widget->parent())->zoomable()->scale();
+    MapRenderer *renderer = mMapDocument->renderer();
+    renderer->setPainterScale(scale);
+
+    for (const MapObjectItem *item : items) {
+        if (!item->isVisible())
+            continue;
+
+        const qreal rotation = item->rotation();
+        if (rotation != 0) {
+            const QPointF pos = item->pos();
+            painter->save();
+            painter->translate(pos);
+            painter->rotate(rotation);
+            painter->translate(-pos);
+        }
+
+        renderer->drawMapObject(painter, item->mapObject(), item->color());
+
+        if (rotation != 0)
+            painter->restore();
+    }
+}
+
+void ObjectGroupItem::addToGrid(MapObjectItem *item, const QRectF &bounds)
+{
+    const int left = gridCoordinate(bounds.left());
+    const int top = gridCoordinate(bounds.top());
+    const int right = gridCoordinate(bounds.right());
+    const int bottom = gridCoordinate(bounds.bottom());
+
+    if ((right - left + 1) * (bottom - top + 1) > MaximumGridCells) {
+        mLargeObjectItems.append(item);
+        return;
+    }
+
+    for (int y = top; y <= bottom; ++y)
+        for (int x = left; x <= right; ++x)
+            mGrid[gridKey(x, y)].append(item);
+}
+
+void ObjectGroupItem::removeFromGrid(MapObjectItem *item, const QRectF &bounds)
+{
+    const int left = gridCoordinate(bounds.left());
+    const int top = gridCoordinate(bounds.top());
+    const int right = gridCoordinate(bounds.right());
+    const int bottom = gridCoordinate(bounds.bottom());
+
+    if ((right - left + 1) * (bottom - top + 1) > MaximumGridCells) {
+        mLargeObjectItems.removeOne(item);
+        return;
+    }
+
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            auto it = mGrid.find(gridKey(x, y));
+            if (it == mGrid.end())
+                continue;
+
+            it.value().removeOne(item);
+            if (it.value().isEmpty())
+                mGrid.erase(it);
+        }
+    }
+}
+
+/**
+ * Sorts the given map object \a items in the order in which the scene would
+ * draw them, bottom-most first.
+ */
+void ObjectGroupItem::sortInDrawingOrder(QVector<MapObjectItem*> &items) const
+{
+    std::sort(items.begin(), items.end(),
+              [this](const MapObjectItem *a, const MapObjectItem *b) {
+        if (a->zValue() != b->zValue())
+            return a->zValue() < b->zValue();
+        return mObjectGroup->indexOf(a->mapObject()) <
+                mObjectGroup->indexOf(b->mapObject());
+    });
 }
 
-void ObjectGroupItem::paint(QPainter *,
-                            const QStyleOptionGraphicsItem *,
-                            QWidget *)
+/**
+ * Returns the map object items of which the bounds intersect with the given
+ * \a rect, in no particular order. The rect is in item coordinates.
+ */
+QVector<MapObjectItem*> ObjectGroupItem::objectItemsIn(const QRectF &rect) const
 {
+    QVector<MapObjectItem*> items;
+
+    const QRectF area = rect & mBoundingRect;
+    if (area.isEmpty())
+        return items;
+
+    const int left = gridCoordinate(area.left());
+    const int top = gridCoordinate(area.top());
+    const int right = gridCoordinate(area.right());
+    const int bottom = gridCoordinate(area.bottom());
+
+    // When looking at a large area, checking all objects is cheaper
+    if (qint64(right - left + 1) * (bottom - top + 1) > mGrid.size()) {
+        for (auto it = mObjectBounds.begin(); it != mObjectBounds.end(); ++it)
+            if (it.value().intersects(area))
+                items.append(it.key());
+        return items;
+    }
+
+    QSet<MapObjectItem*> found;
+
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            const auto it = mGrid.find(gridKey(x, y));
+            if (it == mGrid.end())
+                continue;
+
+            for (MapObjectItem *item : it.value())
+                if (!found.contains(item) && mObjectBounds.value(item).intersects(area))
+                    found.insert(item);
+        }
+    }
+
+    for (MapObjectItem *item : mLargeObjectItems)
+        if (mObjectBounds.value(item).intersects(area))
+            found.insert(item);
+
+    items.reserve(found.size());
+    for (MapObjectItem *item : found)
+        items.append(item);
+
+    return items;
 }
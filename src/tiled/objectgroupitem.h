@@ -22,6 +22,8 @@
 #define OBJECTGROUPITEM_H
 
 #include <QGraphicsItem>
+#include <QHash>
+#include <QVector>
 
 namespace Tiled {
 
@@ -29,19 +31,38 @@ class ObjectGroup;
 
 namespace Internal {
 
+class MapDocument;
+class MapObjectItem;
+
 /**
- * A graphics item representing an object group in a QGraphicsView. It only
- * serves to group together the objects belonging to the same object group.
+ * A graphics item representing an object group in a QGraphicsView. It groups
+ * together the objects belonging to the same object group.
+ *
+ * When constructed with a map document, this item draws all of its map
+ * object items in a single paint call. It keeps a grid of the object bounds,
+ * so that only the objects within the exposed area need to be looked at. The
+ * same grid is used to find the objects at a certain position, since the map
+ * object items are then left out of the scene index.
  *
  * @see MapObjectItem
  */
 class ObjectGroupItem : public QGraphicsItem
 {
 public:
-    ObjectGroupItem(ObjectGroup *objectGroup);
+    ObjectGroupItem(ObjectGroup *objectGroup,
+                    MapDocument *mapDocument = nullptr);
+    ~ObjectGroupItem();
 
     ObjectGroup *objectGroup() const;
 
+    bool drawsObjects() const;
+
+    void syncObjectItem(MapObjectItem *item);
+    void removeObjectItem(MapObjectItem *item);
+
+    QVector<MapObjectItem*> objectItemsIn(const QRectF &rect) const;
+    void sortInDrawingOrder(QVector<MapObjectItem*> &items) const;
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
@@ -49,7 +70,16 @@ public:
                QWidget *widget = nullptr) override;
 
 private:
+    void addToGrid(MapObjectItem *item, const QRectF &bounds);
+    void removeFromGrid(MapObjectItem *item, const QRectF &bounds);
+
     ObjectGroup *mObjectGroup;
+    MapDocument *mMapDocument;
+
+    QRectF mBoundingRect;
+    QHash<MapObjectItem*, QRectF> mObjectBounds;
+    QHash<quint64, QVector<MapObjectItem*>> mGrid;
+    QVector<MapObjectItem*> mLargeObjectItems;
 };
 
 inline ObjectGroup *ObjectGroupItem::objectGroup() const
@@ -57,6 +87,15 @@ inline ObjectGroup *ObjectGroupItem::objectGroup() const
     return mObjectGroup;
 }
 
+/**
+ * Returns whether this item draws its objects, rather than leaving that to
+ * the map object items.
+ */
+inline bool ObjectGroupItem::drawsObjects() const
+{
+    return mMapDocument != nullptr;
+}
+
 } // namespace Internal
 } // namespace Tiled
 
@@ -33,6 +33,7 @@
 #include <QApplication>
 #include <QBoxLayout>
 #include <QContextMenuEvent>
+#include <QHash>
 #include <QHeaderView>
 #include <QLabel>
 #include <QMenu>
@@ -40,6 +41,9 @@
 #include <QToolBar>
 #include <QToolButton>
 #include <QUrl>
+#include <QVector>
+
+#include <algorithm>
 
 static const char FIRST_SECTION_SIZE_KEY[] = "ObjectsDock/FirstSectionSize";
 
@@ -351,9 +355,27 @@ void ObjectsView::synchronizeSelectedItems()
     const QList<MapObject *> &selectedObjects = mMapDocument->selectedObjects();
     QItemSelection itemSelection;
 
+    // Group the selected rows by object group, so that contiguous rows can
+    // be selected as a single range.
+    QHash<ObjectGroup*, QVector<int>> rowsByGroup;
     for (MapObject *o : selectedObjects) {
-        QModelIndex index = model()->index(o);
-        itemSelection.select(index, index);
+        ObjectGroup *og = o->objectGroup();
+        rowsByGroup[og].append(og->indexOf(o));
+    }
+
+    for (auto it = rowsByGroup.begin(); it != rowsByGroup.end(); ++it) {
+        const QModelIndex parent = model()->index(it.key());
+        QVector<int> &rows = it.value();
+        std::sort(rows.begin(), rows.end());
+
+        int first = 0;
+        for (int i = 1; i <= rows.size(); ++i) {
+            if (i == rows.size() || rows.at(i) != rows.at(i - 1) + 1) {
+                itemSelection.select(model()->index(rows.at(first), 0, parent),
+                                     model()->index(rows.at(i - 1), 0, parent));
+                first = i;
+            }
+        }
     }
 
     mSynching = true;
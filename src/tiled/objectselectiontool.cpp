@@ -44,6 +44,7 @@
 #include <QGraphicsItem>
 #include <QGraphicsView>
 #include <QKeyEvent>
+#include <QPainterPath>
 #include <QTransform>
 #include <QUndoStack>
 
@@ -924,14 +925,13 @@ void ObjectSelectionTool::updateSelection(const QPointF &pos,
     rect.setWidth(qMax(qreal(1), rect.width()));
     rect.setHeight(qMax(qreal(1), rect.height()));
 
+    QPainterPath area;
+    area.addRect(rect);
+
     QSet<MapObjectItem*> selectedItems;
 
-    const QList<QGraphicsItem *> &items = mapScene()->items(rect);
-    for (QGraphicsItem *item : items) {
-        MapObjectItem *mapObjectItem = dynamic_cast<MapObjectItem*>(item);
-        if (mapObjectItem)
-            selectedItems.insert(mapObjectItem);
-    }
+    for (MapObjectItem *mapObjectItem : mapScene()->objectItemsIn(area))
+        selectedItems.insert(mapObjectItem);
 
     if (modifiers & (Qt::ControlModifier | Qt::ShiftModifier))
         selectedItems |= mapScene()->selectedObjectItems();
@@ -61,6 +61,8 @@ Preferences::Preferences()
             (intValue("MapRenderOrder", Map::RightDown));
     mDtdEnabled = boolValue("DtdEnabled");
     mReloadTilesetsOnChange = boolValue("ReloadTilesets", true);
+    mSaveJournalEnabled = boolValue("SaveJournal");
+    mReloadMapsIncrementally = boolValue("ReloadMapsIncrementally");
     mStampsDirectory = stringValue("StampsDirectory");
     mObjectTypesFile = stringValue("ObjectTypesFile");
     mSettings->endGroup();
@@ -113,6 +115,8 @@ Preferences::Preferences()
         mSettings->remove(QLatin1String("ObjectTypes"));
     }
 
+    updateObjectTypeIndexes();
+
 
     mSettings->beginGroup(QLatin1String("Automapping"));
     mAutoMapDrawing = boolValue("WhileDrawing");
@@ -392,6 +396,28 @@ void Preferences::setReloadTilesetsOnChanged(bool value)
     tilesetManager->setReloadTilesetsOnChange(mReloadTilesetsOnChange);
 }
 
+bool Preferences::saveJournalEnabled() const
+{
+    return mSaveJournalEnabled;
+}
+
+void Preferences::setSaveJournalEnabled(bool enabled)
+{
+    mSaveJournalEnabled = enabled;
+    mSettings->setValue(QLatin1String("Storage/SaveJournal"), enabled);
+}
+
+bool Preferences::reloadMapsIncrementally() const
+{
+    return mReloadMapsIncrementally;
+}
+
+void Preferences::setReloadMapsIncrementally(bool enabled)
+{
+    mReloadMapsIncrementally = enabled;
+    mSettings->setValue(QLatin1String("Storage/ReloadMapsIncrementally"), enabled);
+}
+
 void Preferences::setUseOpenGL(bool useOpenGL)
 {
     if (mUseOpenGL == useOpenGL)
@@ -406,9 +432,39 @@ void Preferences::setUseOpenGL(bool useOpenGL)
 void Preferences::setObjectTypes(const ObjectTypes &objectTypes)
 {
     mObjectTypes = objectTypes;
+    updateObjectTypeIndexes();
     emit objectTypesChanged();
 }
 
+/**
+ * Returns the object type with the given \a name, or null when there is no
+ * such type. When several types have the same name, the first one is
+ * returned.
+ */
+const ObjectType *Preferences::objectType(const QString &name,
+                                          Qt::CaseSensitivity cs) const
+{
+    int index;
+    if (cs == Qt::CaseSensitive)
+        index = mObjectTypeIndexes.value(name, -1);
+    else
+        index = mObjectTypeIndexesCaseInsensitive.value(name.toLower(), -1);
+
+    return index != -1 ? &mObjectTypes.at(index) : nullptr;
+}
+
+void Preferences::updateObjectTypeIndexes()
+{
+    mObjectTypeIndexes.clear();
+    mObjectTypeIndexesCaseInsensitive.clear();
+
+    for (int i = mObjectTypes.size() - 1; i >= 0; --i) {
+        const QString &name = mObjectTypes.at(i).name;
+        mObjectTypeIndexes.insert(name, i);
+        mObjectTypeIndexesCaseInsensitive.insert(name.toLower(), i);
+    }
+}
+
 static QString lastPathKey(Preferences::FileType fileType)
 {
     QString key = QLatin1String("LastPaths/");
@@ -24,6 +24,7 @@
 
 #include <QColor>
 #include <QDate>
+#include <QHash>
 #include <QObject>
 
 #include "map.h"
@@ -98,12 +99,21 @@ public:
     bool reloadTilesetsOnChange() const;
     void setReloadTilesetsOnChanged(bool value);
 
+    bool saveJournalEnabled() const;
+    void setSaveJournalEnabled(bool enabled);
+
+    bool reloadMapsIncrementally() const;
+    void setReloadMapsIncrementally(bool enabled);
+
     bool useOpenGL() const { return mUseOpenGL; }
     void setUseOpenGL(bool useOpenGL);
 
     const ObjectTypes &objectTypes() const { return mObjectTypes; }
     void setObjectTypes(const ObjectTypes &objectTypes);
 
+    const ObjectType *objectType(const QString &name,
+                                 Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
     enum FileType {
         ObjectTypesFile,
         ImageFile,
@@ -196,6 +206,8 @@ private:
     int intValue(const char *key, int defaultValue) const;
     qreal realValue(const char *key, qreal defaultValue) const;
 
+    void updateObjectTypeIndexes();
+
     QSettings *mSettings;
 
     bool mShowGrid;
@@ -220,8 +232,12 @@ private:
     bool mDtdEnabled;
     QString mLanguage;
     bool mReloadTilesetsOnChange;
+    bool mSaveJournalEnabled;
+    bool mReloadMapsIncrementally;
     bool mUseOpenGL;
     ObjectTypes mObjectTypes;
+    QHash<QString, int> mObjectTypeIndexes;
+    QHash<QString, int> mObjectTypeIndexesCaseInsensitive;
 
     bool mAutoMapDrawing;
 
@@ -85,6 +85,10 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
             preferences, &Preferences::setReloadTilesetsOnChanged);
     connect(mUi->openLastFiles, &QCheckBox::toggled,
             preferences, &Preferences::setOpenLastFilesOnStartup);
+    connect(mUi->saveJournal, &QCheckBox::toggled,
+            preferences, &Preferences::setSaveJournalEnabled);
+    connect(mUi->reloadMapsIncrementally, &QCheckBox::toggled,
+            preferences, &Preferences::setReloadMapsIncrementally);
 
     connect(mUi->languageCombo, SIGNAL(currentIndexChanged(int)),
             SLOT(languageSelected(int)));
@@ -146,6 +150,8 @@ void PreferencesDialog::fromPreferences()
     mUi->reloadTilesetImages->setChecked(prefs->reloadTilesetsOnChange());
     mUi->enableDtd->setChecked(prefs->dtdEnabled());
     mUi->openLastFiles->setChecked(prefs->openLastFilesOnStartup());
+    mUi->saveJournal->setChecked(prefs->saveJournalEnabled());
+    mUi->reloadMapsIncrementally->setChecked(prefs->reloadMapsIncrementally());
     if (mUi->openGL->isEnabled())
         mUi->openGL->setChecked(prefs->useOpenGL());
 
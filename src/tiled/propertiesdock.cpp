@@ -154,13 +154,8 @@ static bool isAddedByType(Object *object, const QString &name)
         return false;
 
     const QString objectType = static_cast<MapObject*>(object)->type();
-    const ObjectTypes objectTypes = Preferences::instance()->objectTypes();
-    for (const ObjectType &type : objectTypes) {
-        if (type.name == objectType)
-            return type.defaultProperties.contains(name);
-    }
-
-    return false;
+    const ObjectType *type = Preferences::instance()->objectType(objectType);
+    return type && type->defaultProperties.contains(name);
 }
 
 void PropertiesDock::currentObjectChanged(Object *object)
@@ -1222,15 +1222,13 @@ void PropertyBrowser::updateCustomProperties()
     // Add properties based on object type, if defined
     if (mObject->typeId() == Object::MapObjectType) {
         const QString currentType = static_cast<MapObject*>(mObject)->type();
-        const ObjectTypes objectTypes = Preferences::instance()->objectTypes();
-        for (const ObjectType &type : objectTypes) {
-            if (type.name == currentType) {
-                QMapIterator<QString,QVariant> it(type.defaultProperties);
-                while (it.hasNext()) {
-                    it.next();
-                    if (!mCombinedProperties.contains(it.key()))
-                        mCombinedProperties.insert(it.key(), it.value());
-                }
+        const Preferences *prefs = Preferences::instance();
+        if (const ObjectType *type = prefs->objectType(currentType)) {
+            QMapIterator<QString,QVariant> it(type->defaultProperties);
+            while (it.hasNext()) {
+                it.next();
+                if (!mCombinedProperties.contains(it.key()))
+                    mCombinedProperties.insert(it.key(), it.value());
             }
         }
     }
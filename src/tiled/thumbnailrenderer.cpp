@@ -55,6 +55,8 @@ ThumbnailRenderer::ThumbnailRenderer(Map *map)
         mRenderer = new OrthogonalRenderer(map);
         break;
     }
+
+    mRenderer->setFlatColorTileSize(2);
 }
 
 ThumbnailRenderer::~ThumbnailRenderer()
@@ -13,7 +13,7 @@ win32 {
     DESTDIR = ../../bin
 }
 
-QT += widgets
+QT += widgets concurrent
 
 contains(QT_CONFIG, opengl):!macx: QT += opengl
 
@@ -80,8 +80,10 @@ SOURCES += aboutdialog.cpp \
     automapper.cpp \
     automapperwrapper.cpp \
     automappingmanager.cpp \
+    automappingrulecache.cpp \
     automappingutils.cpp  \
     autoupdater.cpp \
+    batchexporter.cpp \
     brokenlinks.cpp \
     brushitem.cpp \
     bucketfilltool.cpp \
@@ -135,6 +137,7 @@ SOURCES += aboutdialog.cpp \
     magicwandtool.cpp \
     main.cpp \
     mainwindow.cpp \
+    mapdiff.cpp \
     mapdocumentactionhandler.cpp \
     mapdocument.cpp \
     mapobjectitem.cpp \
@@ -232,8 +235,10 @@ HEADERS += aboutdialog.h \
     automapper.h \
     automapperwrapper.h \
     automappingmanager.h \
+    automappingrulecache.h \
     automappingutils.h \
     autoupdater.h \
+    batchexporter.h \
     brokenlinks.h \
     brushitem.h \
     bucketfilltool.h \
@@ -288,6 +293,7 @@ HEADERS += aboutdialog.h \
     macsupport.h \
     magicwandtool.h \
     mainwindow.h \
+    mapdiff.h \
     mapdocumentactionhandler.h \
     mapdocument.h \
     mapobjectitem.h \
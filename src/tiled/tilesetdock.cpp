@@ -313,6 +313,8 @@ TilesetDock::TilesetDock(QWidget *parent):
 
     connect(TilesetManager::instance(), SIGNAL(tilesetChanged(Tileset*)),
             this, SLOT(tilesetChanged(Tileset*)));
+    connect(TilesetManager::instance(), &TilesetManager::tileImagesChanged,
+            this, &TilesetDock::tileImagesChanged);
 
     connect(DocumentManager::instance(), SIGNAL(documentAboutToClose(MapDocument*)),
             SLOT(documentAboutToClose(MapDocument*)));
@@ -647,6 +649,17 @@ void TilesetDock::tilesetChanged(Tileset *tileset)
         model->tilesetChanged();
 }
 
+void TilesetDock::tileImagesChanged(const QList<Tile *> &tiles)
+{
+    // Only the changed tiles of the affected tileset view need repainting
+    const int index = indexOf(mTilesets, tiles.first()->tileset());
+    if (index < 0)
+        return;
+
+    if (TilesetModel *model = tilesetViewAt(index)->tilesetModel())
+        model->tilesChanged(tiles);
+}
+
 void TilesetDock::tilesetRemoved(Tileset *tileset)
 {
     // Delete the related tileset view
@@ -117,6 +117,7 @@ private slots:
 
     void tilesetAdded(int index, Tileset *tileset);
     void tilesetChanged(Tileset *tileset);
+    void tileImagesChanged(const QList<Tile*> &tiles);
     void tilesetRemoved(Tileset *tileset);
     void tilesetMoved(int from, int to);
     void tilesetReplaced(int index, Tileset *tileset);
@@ -35,6 +35,7 @@ TilesetManager *TilesetManager::mInstance;
 TilesetManager::TilesetManager():
     mWatcher(new FileSystemWatcher(this)),
     mAnimationDriver(new TileAnimationDriver(this)),
+    mBackgroundSaves(0),
     mReloadTilesetsOnChange(false)
 {
     connect(mWatcher, SIGNAL(fileChanged(QString)),
@@ -137,6 +138,20 @@ void TilesetManager::setReloadTilesetsOnChange(bool enabled)
     // TODO: Clear the file system watcher when disabled
 }
 
+void TilesetManager::beginBackgroundSave()
+{
+    ++mBackgroundSaves;
+}
+
+void TilesetManager::endBackgroundSave()
+{
+    Q_ASSERT(mBackgroundSaves > 0);
+    --mBackgroundSaves;
+
+    if (mBackgroundSaves == 0 && !mChangedFiles.isEmpty())
+        mChangedFilesTimer.start();
+}
+
 /**
  * Sets whether tile animations are running.
  */
@@ -181,11 +196,49 @@ void TilesetManager::fileChanged(const QString &path)
 
 void TilesetManager::fileChangedTimeout()
 {
+    // Reloaded when the last background save has finished
+    if (mBackgroundSaves > 0)
+        return;
+
     for (SharedTileset &tileset : tilesets()) {
         QString fileName = tileset->imageSource();
-        if (mChangedFiles.contains(fileName))
-            if (tileset->loadFromImage(fileName))
+        if (!mChangedFiles.contains(fileName))
+            continue;
+
+        const QImage image(fileName);
+
+        // Only tiles that actually changed are updated, unless the image
+        // could not be loaded before or its size changed, in which case the
+        // tiles may have moved around (and may need adjusting).
+        if (!tileset->imageLoaded() || image.size() != QSize(tileset->imageWidth(),
+                                                              tileset->imageHeight())) {
+            if (tileset->loadFromImage(image, fileName))
                 emit tilesetChanged(tileset.data());
+            continue;
+        }
+
+        QList<Tile*> changedTiles;
+        if (!tileset->reloadFromImage(image, changedTiles) || changedTiles.isEmpty())
+            continue;
+
+        // Animated tiles show the changed images as well
+        QSet<int> changedTileIds;
+        for (const Tile *tile : changedTiles)
+            changedTileIds.insert(tile->id());
+
+        for (Tile *tile : tileset->tiles()) {
+            if (changedTileIds.contains(tile->id()))
+                continue;
+
+            for (const Frame &frame : tile->frames()) {
+                if (changedTileIds.contains(frame.tileId)) {
+                    changedTiles.append(tile);
+                    break;
+                }
+            }
+        }
+
+        emit tileImagesChanged(changedTiles);
     }
 
     mChangedFiles.clear();
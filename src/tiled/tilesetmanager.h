@@ -105,6 +105,13 @@ public:
     void setReloadTilesetsOnChange(bool enabled);
     bool reloadTilesetsOnChange() const;
 
+    /**
+     * Maps that are saved in the background share their tilesets. While
+     * such a save is in progress, changed tileset images are not reloaded.
+     */
+    void beginBackgroundSave();
+    void endBackgroundSave();
+
     void setAnimateTiles(bool enabled);
     bool animateTiles() const;
     void resetTileAnimations();
@@ -125,6 +132,14 @@ signals:
      */
     void repaintTileset(Tileset *tileset);
 
+    /**
+     * Emitted when the images of the given \a tiles have changed, because
+     * they were reloaded from a modified tileset image. All tiles are part
+     * of the same tileset. Tiles that are animated using any of these tiles
+     * are included.
+     */
+    void tileImagesChanged(const QList<Tile*> &tiles);
+
 private slots:
     void fileChanged(const QString &path);
     void fileChangedTimeout();
@@ -154,6 +169,7 @@ private:
     TileAnimationDriver *mAnimationDriver;
     QSet<QString> mChangedFiles;
     QTimer mChangedFilesTimer;
+    int mBackgroundSaves;
     bool mReloadTilesetsOnChange;
 };
 
@@ -238,12 +238,9 @@ void TileDelegate::paint(QPainter *painter,
     targetRect.setRight(targetRect.left() + tileSize.width() - 1);
 
     // Draw the tile image
-    if (Zoomable *zoomable = mTilesetView->zoomable())
-        if (zoomable->smoothTransform())
-            painter->setRenderHint(QPainter::SmoothPixmapTransform);
-
     if (!tileImage.isNull())
-        painter->drawPixmap(targetRect, tileImage);
+        painter->drawPixmap(targetRect.topLeft(),
+                            mTilesetView->tileThumbnail(tile, targetRect.size()));
     else
         mTilesetView->imageMissingIcon().paint(painter, targetRect, Qt::AlignBottom | Qt::AlignLeft);
 
@@ -688,10 +685,68 @@ void TilesetView::setDrawGrid(bool drawGrid)
 
 void TilesetView::adjustScale()
 {
+    mThumbnails.clear();
+
     if (TilesetModel *model = tilesetModel())
         model->resetModel();
 }
 
+/**
+ * Returns the image of the given \a tile scaled to the given \a size.
+ *
+ * The scaled images are cached, so that painting the view doesn't need to
+ * scale each tile over and over again. The cache is cleared when the model
+ * is reset, which also happens when the zoom level changes.
+ */
+QPixmap TilesetView::tileThumbnail(const Tile *tile, const QSize &size) const
+{
+    const QPixmap &image = tile->image();
+    if (image.size() == size)
+        return image;
+
+    const bool smooth = mZoomable && mZoomable->smoothTransform();
+
+    auto it = mThumbnails.find(tile);
+    if (it != mThumbnails.end()) {
+        const Thumbnail &thumbnail = it.value();
+        if (thumbnail.imageKey == image.cacheKey() &&
+                thumbnail.smooth == smooth &&
+                thumbnail.pixmap.size() == size)
+            return thumbnail.pixmap;
+    } else {
+        it = mThumbnails.insert(tile, Thumbnail());
+    }
+
+    Thumbnail &thumbnail = it.value();
+    thumbnail.imageKey = image.cacheKey();
+    thumbnail.smooth = smooth;
+    thumbnail.pixmap = image.scaled(size, Qt::IgnoreAspectRatio,
+                                    smooth ? Qt::SmoothTransformation
+                                           : Qt::FastTransformation);
+    return thumbnail.pixmap;
+}
+
+void TilesetView::reset()
+{
+    mThumbnails.clear();
+    QTableView::reset();
+}
+
+void TilesetView::dataChanged(const QModelIndex &topLeft,
+                              const QModelIndex &bottomRight,
+                              const QVector<int> &roles)
+{
+    if (!mThumbnails.isEmpty()) {
+        const TilesetModel *model = tilesetModel();
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+            for (int column = topLeft.column(); column <= bottomRight.column(); ++column)
+                if (const Tile *tile = model->tileAt(model->index(row, column)))
+                    mThumbnails.remove(tile);
+    }
+
+    QTableView::dataChanged(topLeft, bottomRight, roles);
+}
+
 void TilesetView::applyTerrain()
 {
     if (!mHoveredIndex.isValid())
@@ -23,6 +23,8 @@
 
 #include "tilesetmodel.h"
 
+#include <QHash>
+#include <QPixmap>
 #include <QTableView>
 
 namespace Tiled {
@@ -111,6 +113,11 @@ public:
 
     QIcon imageMissingIcon() const;
 
+    QPixmap tileThumbnail(const Tile *tile, const QSize &size) const;
+
+public slots:
+    void reset() override;
+
 signals:
     void createNewTerrain(Tile *tile);
     void terrainImageSelected(Tile *tile);
@@ -124,6 +131,11 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
 
+protected slots:
+    void dataChanged(const QModelIndex &topLeft,
+                     const QModelIndex &bottomRight,
+                     const QVector<int> &roles = QVector<int>()) override;
+
 private slots:
     void createNewTerrain();
     void selectTerrainImage();
@@ -154,6 +166,16 @@ private:
     QPoint mLastMousePos;
 
     const QIcon mImageMissingIcon;
+
+    struct Thumbnail
+    {
+        qint64 imageKey;
+        bool smooth;
+        QPixmap pixmap;
+    };
+
+    // Tile images scaled to the current zoom level
+    mutable QHash<const Tile*, Thumbnail> mThumbnails;
 };
 
 inline bool TilesetView::markAnimatedTiles() const
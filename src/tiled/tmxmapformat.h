@@ -42,6 +42,8 @@ public:
 
     bool write(const Map *map, const QString &fileName) override;
 
+    MapFormat *clone() const override { return new TmxMapFormat; }
+
     /**
      * Converts the given map to a utf8 byte array (in .tmx format). This is
      * for storing a map in the clipboard. References to other files (like
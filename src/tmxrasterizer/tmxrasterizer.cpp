@@ -116,7 +116,7 @@ int TmxRasterizer::render(const QString &mapFileName,
     mapSize.rwidth() *= xScale;
     mapSize.rheight() *= yScale;
 
-    QImage image(mapSize, QImage::Format_ARGB32);
+    QImage image(mapSize, QImage::Format_ARGB32_Premultiplied);
     image.fill(Qt::transparent);
     QPainter painter(&image);
 
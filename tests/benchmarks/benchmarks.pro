@@ -0,0 +1,35 @@
+include(../../src/libtiled/libtiled.pri)
+
+QT += testlib
+CONFIG += c++11
+TEMPLATE = app
+
+macx {
+    LIBS += -L$$OUT_PWD/../../bin/Tiled.app/Contents/Frameworks
+    PLUGIN_DIR = $$OUT_PWD/../../bin/Tiled.app/Contents/PlugIns
+} else:win32 {
+    LIBS += -L$$OUT_PWD/../../lib
+    PLUGIN_DIR = $$OUT_PWD/../../plugins/tiled
+} else {
+    LIBS += -L$$OUT_PWD/../../lib
+    PLUGIN_DIR = $$OUT_PWD/../../lib/tiled/plugins
+}
+
+# Used to load the JSON plugin
+DEFINES += BENCHMARK_PLUGIN_DIR=\\\"$$PLUGIN_DIR\\\"
+
+!win32:!macx:!cygwin {
+    QMAKE_RPATHDIR += \$\$ORIGIN/../../lib
+
+    # It is not possible to use ORIGIN in QMAKE_RPATHDIR, so a bit manually
+    QMAKE_LFLAGS += -Wl,-z,origin \'-Wl,-rpath,$$join(QMAKE_RPATHDIR, ":")\'
+    QMAKE_RPATHDIR =
+}
+
+# Input
+SOURCES += \
+    mapgenerator.cpp \
+    test_benchmarks.cpp
+
+HEADERS += \
+    mapgenerator.h
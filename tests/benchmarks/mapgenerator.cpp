@@ -0,0 +1,180 @@
+#include "mapgenerator.h"
+
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * A small xorshift random number generator, used instead of qrand() so that
+ * the generated maps don't depend on the platform or on global state.
+ */
+class Random
+{
+public:
+    explicit Random(quint32 seed) : mState(seed ? seed : 1) {}
+
+    quint32 next()
+    {
+        mState ^= mState << 13;
+        mState ^= mState >> 17;
+        mState ^= mState << 5;
+        return mState;
+    }
+
+    int next(int bound) { return int(next() % quint32(bound)); }
+    qreal nextReal() { return next() / qreal(0xFFFFFFFFu); }
+
+private:
+    quint32 mState;
+};
+
+} // anonymous namespace
+
+MapGenerator::Parameters::Parameters()
+    : orientation(Map::Orthogonal)
+    , width(256)
+    , height(256)
+    , tileWidth(32)
+    , tileHeight(32)
+    , tileLayerCount(4)
+    , tilesetCount(4)
+    , tilesetColumns(8)
+    , density(0.75)
+    , objectGroupCount(2)
+    , objectCount(1000)
+    , seed(1)
+{
+}
+
+MapGenerator::MapGenerator(const Parameters &parameters)
+    : mParameters(parameters)
+{
+}
+
+/**
+ * Generates a map. The tileset images are saved as PNG files to the given
+ * \a tilesetDirectory, so that the map can be written and read back.
+ */
+Map *MapGenerator::generate(const QString &tilesetDirectory) const
+{
+    const Parameters &p = mParameters;
+    Random random(p.seed);
+
+    Map *map = new Map(p.orientation, p.width, p.height,
+                       p.tileWidth, p.tileHeight);
+
+    if (p.orientation == Map::Hexagonal)
+        map->setHexSideLength(p.tileHeight / 2);
+
+    QVector<Tile*> tiles;
+
+    for (int i = 0; i < p.tilesetCount; ++i) {
+        const QString name = QString(QLatin1String("tileset%1")).arg(i);
+        SharedTileset tileset = Tileset::create(name, p.tileWidth, p.tileHeight);
+
+        QImage image(p.tileWidth * p.tilesetColumns,
+                     p.tileHeight * p.tilesetColumns,
+                     QImage::Format_ARGB32);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        for (int y = 0; y < p.tilesetColumns; ++y) {
+            for (int x = 0; x < p.tilesetColumns; ++x) {
+                const QRect rect(x * p.tileWidth, y * p.tileHeight,
+                                 p.tileWidth, p.tileHeight);
+                painter.fillRect(rect.adjusted(1, 1, -1, -1),
+                                 QColor::fromRgb(random.next() | 0xFF000000));
+                painter.drawEllipse(rect.adjusted(4, 4, -4, -4));
+            }
+        }
+        painter.end();
+
+        const QString fileName = QDir(tilesetDirectory).filePath(name + QLatin1String(".png"));
+        image.save(fileName);
+        tileset->loadFromImage(image, fileName);
+
+        for (Tile *tile : tileset->tiles())
+            tiles.append(tile);
+
+        map->addTileset(tileset);
+    }
+
+    for (int i = 0; i < p.tileLayerCount; ++i) {
+        const QString name = QString(QLatin1String("Tile Layer %1")).arg(i + 1);
+        TileLayer *tileLayer = new TileLayer(name, 0, 0, p.width, p.height);
+
+        for (int y = 0; y < p.height; ++y) {
+            for (int x = 0; x < p.width; ++x) {
+                if (tiles.isEmpty() || random.nextReal() >= p.density)
+                    continue;
+
+                Cell cell(tiles.at(random.next(tiles.size())));
+                const quint32 flags = random.next();
+                cell.flippedHorizontally = (flags & 0x70) == 0x10;
+                cell.flippedVertically = (flags & 0x700) == 0x100;
+                cell.flippedAntiDiagonally = (flags & 0x7000) == 0x1000;
+                tileLayer->setCell(x, y, cell);
+            }
+        }
+
+        map->addLayer(tileLayer);
+    }
+
+    const qreal mapWidth = p.width * p.tileWidth;
+    const qreal mapHeight = p.height * p.tileHeight;
+
+    for (int i = 0; i < p.objectGroupCount; ++i) {
+        const QString name = QString(QLatin1String("Object Layer %1")).arg(i + 1);
+        ObjectGroup *objectGroup = new ObjectGroup(name, 0, 0, p.width, p.height);
+        map->addLayer(objectGroup);
+
+        for (int j = 0; j < p.objectCount; ++j) {
+            const QPointF pos(random.nextReal() * mapWidth,
+                              random.nextReal() * mapHeight);
+            const QSizeF size(p.tileWidth * (1 + random.next(4)),
+                              p.tileHeight * (1 + random.next(4)));
+
+            MapObject *object = new MapObject(QString(QLatin1String("Object %1")).arg(j),
+                                              QLatin1String("Type"), pos, size);
+
+            switch (random.next(4)) {
+            case 0:
+                object->setShape(MapObject::Ellipse);
+                break;
+            case 1: {
+                QPolygonF polygon;
+                for (int k = 0; k < 6; ++k)
+                    polygon.append(QPointF(random.nextReal() * size.width(),
+                                           random.nextReal() * size.height()));
+                object->setShape(MapObject::Polygon);
+                object->setPolygon(polygon);
+                break;
+            }
+            case 2:
+                if (!tiles.isEmpty()) {
+                    object->setCell(Cell(tiles.at(random.next(tiles.size()))));
+                    object->setSize(p.tileWidth, p.tileHeight);
+                }
+                break;
+            default:
+                break;
+            }
+
+            object->setId(map->takeNextObjectId());
+            object->setProperty(QLatin1String("index"), QString::number(j));
+            objectGroup->addObject(object);
+        }
+    }
+
+    return map;
+}
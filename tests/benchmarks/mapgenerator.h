@@ -0,0 +1,41 @@
+#ifndef MAPGENERATOR_H
+#define MAPGENERATOR_H
+
+#include "map.h"
+
+#include <QString>
+
+/**
+ * Generates synthetic maps for benchmarking. The same parameters always
+ * result in the same map.
+ */
+class MapGenerator
+{
+public:
+    struct Parameters
+    {
+        Parameters();
+
+        Tiled::Map::Orientation orientation;
+        int width;
+        int height;
+        int tileWidth;
+        int tileHeight;
+        int tileLayerCount;
+        int tilesetCount;
+        int tilesetColumns;     // tilesets are square
+        qreal density;          // fraction of cells that refer to a tile
+        int objectGroupCount;
+        int objectCount;        // objects per object group
+        quint32 seed;
+    };
+
+    explicit MapGenerator(const Parameters &parameters = Parameters());
+
+    Tiled::Map *generate(const QString &tilesetDirectory) const;
+
+private:
+    Parameters mParameters;
+};
+
+#endif // MAPGENERATOR_H
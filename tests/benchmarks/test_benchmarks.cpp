@@ -0,0 +1,368 @@
+#include "mapgenerator.h"
+
+#include "hexagonalrenderer.h"
+#include "isometricrenderer.h"
+#include "map.h"
+#include "mapformat.h"
+#include "mapreader.h"
+#include "mapwriter.h"
+#include "orthogonalrenderer.h"
+#include "plugin.h"
+#include "pluginmanager.h"
+#include "staggeredrenderer.h"
+#include "tilelayer.h"
+
+#include <QBuffer>
+#include <QDirIterator>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPluginLoader>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+/**
+ * Benchmarks for reading, writing and rendering maps as well as for common
+ * tile layer operations, based on synthetic maps.
+ *
+ * The size of the generated maps can be changed using the
+ * TILED_BENCHMARK_MAP_SIZE environment variable (defaults to 256).
+ *
+ * Unless other output options are given, the results are written to
+ * benchmarks.xml in addition to the console.
+ */
+class test_Benchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void writeTmx_data();
+    void writeTmx();
+
+    void readTmx_data();
+    void readTmx();
+
+    void writeJson();
+    void readJson();
+
+    void drawTileLayer_data();
+    void drawTileLayer();
+
+    void tileLayerClone();
+    void tileLayerRegion();
+    void tileLayerConditionalRegion();
+    void tileLayerCopy();
+    void tileLayerMerge();
+    void tileLayerDiffRegion();
+    void tileLayerResize();
+
+private:
+    MapGenerator::Parameters parameters(Map::Orientation orientation) const;
+    MapFormat *jsonFormat() const;
+
+    QTemporaryDir mTemporaryDir;
+    Map *mMap;
+};
+
+static void addLayerDataFormats()
+{
+    QTest::addColumn<Map::LayerDataFormat>("format");
+
+    QTest::newRow("xml") << Map::XML;
+    QTest::newRow("csv") << Map::CSV;
+    QTest::newRow("base64") << Map::Base64;
+    QTest::newRow("base64-zlib") << Map::Base64Zlib;
+    QTest::newRow("base64-gzip") << Map::Base64Gzip;
+}
+
+static TileLayer *firstTileLayer(const Map *map)
+{
+    return map->layerAt(0)->asTileLayer();
+}
+
+MapGenerator::Parameters test_Benchmarks::parameters(Map::Orientation orientation) const
+{
+    MapGenerator::Parameters parameters;
+    parameters.orientation = orientation;
+
+    const int size = qgetenv("TILED_BENCHMARK_MAP_SIZE").toInt();
+    if (size > 0) {
+        parameters.width = size;
+        parameters.height = size;
+    }
+
+    return parameters;
+}
+
+/**
+ * Returns the map format provided by the JSON plugin, or null when the
+ * plugin could not be loaded.
+ */
+MapFormat *test_Benchmarks::jsonFormat() const
+{
+    for (MapFormat *format : PluginManager::objects<MapFormat>())
+        if (format->supportsFile(QLatin1String("map.json")))
+            return format;
+    return nullptr;
+}
+
+void test_Benchmarks::initTestCase()
+{
+    QVERIFY(mTemporaryDir.isValid());
+
+    MapGenerator generator(parameters(Map::Orthogonal));
+    mMap = generator.generate(mTemporaryDir.path());
+
+    // Only the JSON plugin is loaded, since the other plugins are not needed
+    PluginManager::instance();
+    QDirIterator iterator(QLatin1String(BENCHMARK_PLUGIN_DIR), QDir::Files);
+    while (iterator.hasNext()) {
+        const QString fileName = iterator.next();
+        if (!QLibrary::isLibrary(fileName) || !iterator.fileName().contains(QLatin1String("json")))
+            continue;
+
+        QPluginLoader *loader = new QPluginLoader(fileName, this);
+        if (Plugin *plugin = qobject_cast<Plugin*>(loader->instance()))
+            plugin->initialize();
+    }
+}
+
+void test_Benchmarks::cleanupTestCase()
+{
+    delete mMap;
+    mMap = nullptr;
+
+    PluginManager::deleteInstance();
+}
+
+void test_Benchmarks::writeTmx_data()
+{
+    addLayerDataFormats();
+}
+
+void test_Benchmarks::writeTmx()
+{
+    QFETCH(Map::LayerDataFormat, format);
+
+    mMap->setLayerDataFormat(format);
+    MapWriter writer;
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        writer.writeMap(mMap, &buffer, mTemporaryDir.path());
+    }
+}
+
+void test_Benchmarks::readTmx_data()
+{
+    addLayerDataFormats();
+}
+
+void test_Benchmarks::readTmx()
+{
+    QFETCH(Map::LayerDataFormat, format);
+
+    mMap->setLayerDataFormat(format);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    MapWriter().writeMap(mMap, &buffer, mTemporaryDir.path());
+    buffer.close();
+
+    MapReader reader;
+
+    QBENCHMARK {
+        buffer.open(QIODevice::ReadOnly);
+        Map *map = reader.readMap(&buffer, mTemporaryDir.path());
+        buffer.close();
+
+        QVERIFY2(map, qPrintable(reader.errorString()));
+        delete map;
+    }
+}
+
+void test_Benchmarks::writeJson()
+{
+    MapFormat *format = jsonFormat();
+    if (!format)
+        QSKIP("The JSON plugin is not available");
+
+    mMap->setLayerDataFormat(Map::CSV);
+    const QString fileName = QDir(mTemporaryDir.path()).filePath(QLatin1String("map.json"));
+
+    QBENCHMARK {
+        QVERIFY2(format->write(mMap, fileName), qPrintable(format->errorString()));
+    }
+}
+
+void test_Benchmarks::readJson()
+{
+    MapFormat *format = jsonFormat();
+    if (!format)
+        QSKIP("The JSON plugin is not available");
+
+    mMap->setLayerDataFormat(Map::CSV);
+    const QString fileName = QDir(mTemporaryDir.path()).filePath(QLatin1String("map.json"));
+    QVERIFY2(format->write(mMap, fileName), qPrintable(format->errorString()));
+
+    QBENCHMARK {
+        Map *map = format->read(fileName);
+        QVERIFY2(map, qPrintable(format->errorString()));
+        delete map;
+    }
+}
+
+void test_Benchmarks::drawTileLayer_data()
+{
+    QTest::addColumn<Map::Orientation>("orientation");
+    QTest::addColumn<qreal>("scale");
+
+    QTest::newRow("orthogonal") << Map::Orthogonal << qreal(1);
+    QTest::newRow("orthogonal-zoomed-out") << Map::Orthogonal << qreal(0.1);
+    QTest::newRow("isometric") << Map::Isometric << qreal(1);
+    QTest::newRow("isometric-zoomed-out") << Map::Isometric << qreal(0.1);
+    QTest::newRow("staggered") << Map::Staggered << qreal(1);
+    QTest::newRow("staggered-zoomed-out") << Map::Staggered << qreal(0.1);
+    QTest::newRow("hexagonal") << Map::Hexagonal << qreal(1);
+    QTest::newRow("hexagonal-zoomed-out") << Map::Hexagonal << qreal(0.1);
+}
+
+void test_Benchmarks::drawTileLayer()
+{
+    QFETCH(Map::Orientation, orientation);
+    QFETCH(qreal, scale);
+
+    QScopedPointer<Map> map(MapGenerator(parameters(orientation)).generate(mTemporaryDir.path()));
+    const TileLayer *tileLayer = firstTileLayer(map.data());
+
+    QScopedPointer<MapRenderer> renderer;
+    switch (orientation) {
+    case Map::Isometric:
+        renderer.reset(new IsometricRenderer(map.data()));
+        break;
+    case Map::Staggered:
+        renderer.reset(new StaggeredRenderer(map.data()));
+        break;
+    case Map::Hexagonal:
+        renderer.reset(new HexagonalRenderer(map.data()));
+        break;
+    default:
+        renderer.reset(new OrthogonalRenderer(map.data()));
+        break;
+    }
+    renderer->setPainterScale(scale);
+
+    // Render a typical viewport, starting at the center of the map
+    QImage image(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+    const QSizeF mapSize = renderer->mapSize();
+    const QRectF exposed(QPointF(mapSize.width() / 2, mapSize.height() / 2),
+                         QSizeF(image.size()) / scale);
+
+    QBENCHMARK {
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.scale(scale, scale);
+        painter.translate(-exposed.topLeft());
+        renderer->drawTileLayer(&painter, tileLayer, exposed);
+    }
+}
+
+void test_Benchmarks::tileLayerClone()
+{
+    const TileLayer *tileLayer = firstTileLayer(mMap);
+
+    QBENCHMARK {
+        delete tileLayer->clone();
+    }
+}
+
+void test_Benchmarks::tileLayerRegion()
+{
+    const TileLayer *tileLayer = firstTileLayer(mMap);
+
+    QBENCHMARK {
+        tileLayer->region();
+    }
+}
+
+void test_Benchmarks::tileLayerConditionalRegion()
+{
+    const TileLayer *tileLayer = firstTileLayer(mMap);
+    const Cell cell = tileLayer->cellAt(0, 0);
+
+    // Like the Select Same Tile tool
+    QBENCHMARK {
+        tileLayer->region([&] (const Cell &c) { return c.tile == cell.tile; });
+    }
+}
+
+void test_Benchmarks::tileLayerCopy()
+{
+    const TileLayer *tileLayer = firstTileLayer(mMap);
+
+    QRegion region;
+    for (int i = 0; i < 8; ++i)
+        region += QRect(i * tileLayer->width() / 10, i * tileLayer->height() / 10,
+                        tileLayer->width() / 4, tileLayer->height() / 4);
+
+    QBENCHMARK {
+        delete tileLayer->copy(region);
+    }
+}
+
+void test_Benchmarks::tileLayerMerge()
+{
+    QScopedPointer<TileLayer> tileLayer(static_cast<TileLayer*>(firstTileLayer(mMap)->clone()));
+    const TileLayer *other = mMap->layerAt(1)->asTileLayer();
+
+    QBENCHMARK {
+        tileLayer->merge(QPoint(), other);
+    }
+}
+
+void test_Benchmarks::tileLayerDiffRegion()
+{
+    const TileLayer *tileLayer = firstTileLayer(mMap);
+    QScopedPointer<TileLayer> modified(static_cast<TileLayer*>(tileLayer->clone()));
+    modified->erase(QRegion(0, 0, modified->width() / 2, modified->height() / 2));
+
+    QBENCHMARK {
+        tileLayer->computeDiffRegion(modified.data());
+    }
+}
+
+void test_Benchmarks::tileLayerResize()
+{
+    const TileLayer *tileLayer = firstTileLayer(mMap);
+    const QSize newSize(tileLayer->width() + 32, tileLayer->height() + 32);
+
+    // Resizing changes the layer, so the time includes cloning it
+    QBENCHMARK {
+        QScopedPointer<TileLayer> copy(static_cast<TileLayer*>(tileLayer->clone()));
+        copy->resize(newSize, QPoint(16, 16));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    test_Benchmarks benchmarks;
+
+    // Keep a machine-readable record of the results unless the output was
+    // configured explicitly
+    QStringList arguments = app.arguments();
+    if (!arguments.contains(QLatin1String("-o"))) {
+        arguments << QLatin1String("-o") << QLatin1String("-,txt")
+                  << QLatin1String("-o") << QLatin1String("benchmarks.xml,xml");
+    }
+
+    return QTest::qExec(&benchmarks, arguments);
+}
+
+#include "test_benchmarks.moc"
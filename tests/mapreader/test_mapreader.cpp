@@ -3,7 +3,9 @@
 #include "objectgroup.h"
 #include "tilelayer.h"
 #include "mapreader.h"
+#include "mapwriter.h"
 
+#include <QBuffer>
 #include <QtTest/QtTest>
 
 using namespace Tiled;
@@ -14,6 +16,7 @@ class test_MapReader : public QObject
 
 private slots:
     void loadMap();
+    void writeSnapshotWithHiddenObject();
 };
 
 void test_MapReader::loadMap()
@@ -53,5 +56,41 @@ void test_MapReader::loadMap()
     QCOMPARE(mapObject->height(), qreal(64));
 }
 
+/**
+ * Background saves write a copy of the map, so the copy needs to keep the
+ * visibility of objects.
+ */
+void test_MapReader::writeSnapshotWithHiddenObject()
+{
+    Map map(Map::Orthogonal, 10, 10, 32, 32);
+    ObjectGroup *objectGroup = new ObjectGroup(QLatin1String("Objects"), 0, 0, 10, 10);
+    map.addLayer(objectGroup);
+
+    MapObject *hidden = new MapObject(QLatin1String("Hidden"), QString(),
+                                      QPointF(32, 32), QSizeF(32, 32));
+    hidden->setId(map.takeNextObjectId());
+    hidden->setVisible(false);
+    objectGroup->addObject(hidden);
+
+    const Map snapshot(map);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    MapWriter().writeMap(&snapshot, &buffer);
+    buffer.close();
+
+    QVERIFY(buffer.data().contains("visible=\"0\""));
+
+    buffer.open(QIODevice::ReadOnly);
+    MapReader reader;
+    QScopedPointer<Map> readMap(reader.readMap(&buffer));
+    QVERIFY2(readMap, qPrintable(reader.errorString()));
+
+    ObjectGroup *readGroup = readMap->layerAt(0)->asObjectGroup();
+    QVERIFY(readGroup);
+    QCOMPARE(readGroup->objectCount(), 1);
+    QCOMPARE(readGroup->objectAt(0)->isVisible(), false);
+}
+
 QTEST_MAIN(test_MapReader)
 #include "test_mapreader.moc"
@@ -0,0 +1,123 @@
+#include "map.h"
+#include "orthogonalrenderer.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QPainter>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+/**
+ * Checks that drawing tile layers straight into an image gives the same
+ * result as drawing them through the paint engine.
+ */
+class test_OrthogonalRenderer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void drawTileLayer_data();
+    void drawTileLayer();
+};
+
+static bool fuzzyCompare(QRgb a, QRgb b)
+{
+    return qAbs(qRed(a) - qRed(b)) <= 1 &&
+            qAbs(qGreen(a) - qGreen(b)) <= 1 &&
+            qAbs(qBlue(a) - qBlue(b)) <= 1 &&
+            qAbs(qAlpha(a) - qAlpha(b)) <= 1;
+}
+
+void test_OrthogonalRenderer::drawTileLayer_data()
+{
+    QTest::addColumn<bool>("flippedHorizontally");
+    QTest::addColumn<bool>("flippedVertically");
+    QTest::addColumn<bool>("flippedAntiDiagonally");
+    QTest::addColumn<qreal>("opacity");
+
+    QTest::newRow("none") << false << false << false << qreal(1);
+    QTest::newRow("horizontal") << true << false << false << qreal(1);
+    QTest::newRow("vertical") << false << true << false << qreal(1);
+    QTest::newRow("both") << true << true << false << qreal(1);
+    QTest::newRow("anti-diagonal") << false << false << true << qreal(1);
+    QTest::newRow("anti-diagonal-horizontal") << true << false << true << qreal(1);
+    QTest::newRow("anti-diagonal-vertical") << false << true << true << qreal(1);
+    QTest::newRow("anti-diagonal-both") << true << true << true << qreal(1);
+    QTest::newRow("opacity") << true << false << true << qreal(0.5);
+}
+
+void test_OrthogonalRenderer::drawTileLayer()
+{
+    QFETCH(bool, flippedHorizontally);
+    QFETCH(bool, flippedVertically);
+    QFETCH(bool, flippedAntiDiagonally);
+    QFETCH(qreal, opacity);
+
+    // Tiles that are not square and partly translucent, to notice any
+    // mistakes in the flipping and blending
+    const int tileWidth = 4;
+    const int tileHeight = 3;
+
+    QImage tilesetImage(tileWidth * 2, tileHeight, QImage::Format_ARGB32);
+    for (int y = 0; y < tilesetImage.height(); ++y)
+        for (int x = 0; x < tilesetImage.width(); ++x)
+            tilesetImage.setPixel(x, y, qRgba(x * 30, y * 80, 200 - x * 20,
+                                              (x + y) % 3 ? 255 : 100 + x * 10));
+
+    SharedTileset tileset = Tileset::create(QLatin1String("tiles"), tileWidth, tileHeight);
+    tileset->loadFromImage(tilesetImage, QLatin1String("tiles.png"));
+
+    Map map(Map::Orthogonal, 4, 4, tileWidth, tileHeight);
+    map.addTileset(tileset);
+
+    TileLayer *layer = new TileLayer(QLatin1String("Tile Layer 1"), 0, 0, 4, 4);
+    for (int y = 0; y < layer->height(); ++y) {
+        for (int x = 0; x < layer->width(); ++x) {
+            Cell cell(tileset->findTile((x + y) % 2));
+            cell.flippedHorizontally = flippedHorizontally;
+            cell.flippedVertically = flippedVertically;
+            cell.flippedAntiDiagonally = flippedAntiDiagonally;
+            layer->setCell(x, y, cell);
+        }
+    }
+    map.addLayer(layer);
+
+    OrthogonalRenderer renderer(&map);
+
+    // Tiles are partly drawn outside of the image, to test the clipping
+    QImage blitted(15, 12, QImage::Format_ARGB32_Premultiplied);
+    blitted.fill(QColor(40, 80, 120));
+    QImage painted = blitted.copy();
+
+    {
+        QPainter painter(&blitted);
+        painter.setOpacity(opacity);
+        painter.translate(-2, -1);
+        renderer.drawTileLayer(&painter, layer);
+    }
+    {
+        // Clipping makes the renderer go through the paint engine
+        QPainter painter(&painted);
+        painter.setClipRect(painted.rect());
+        painter.setOpacity(opacity);
+        painter.translate(-2, -1);
+        renderer.drawTileLayer(&painter, layer);
+    }
+
+    for (int y = 0; y < blitted.height(); ++y) {
+        for (int x = 0; x < blitted.width(); ++x) {
+            const QRgb actual = blitted.pixel(x, y);
+            const QRgb expected = painted.pixel(x, y);
+            QVERIFY2(fuzzyCompare(actual, expected),
+                     qPrintable(QString(QLatin1String("Pixel %1,%2 is %3 instead of %4"))
+                                .arg(x).arg(y)
+                                .arg(actual, 8, 16, QLatin1Char('0'))
+                                .arg(expected, 8, 16, QLatin1Char('0'))));
+        }
+    }
+}
+
+QTEST_MAIN(test_OrthogonalRenderer)
+#include "test_orthogonalrenderer.moc"
@@ -0,0 +1,185 @@
+#include "map.h"
+#include "savejournal.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_SaveJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void appendAndReplay();
+    void truncatedRecord();
+    void tilesetGrew();
+    void outdatedJournal();
+
+private:
+    Map *createMap() const;
+    static TileLayer *tileLayer(Map *map) { return map->layerAt(0)->asTileLayer(); }
+
+    QTemporaryDir mDir;
+    QString mMapFileName;
+    SharedTileset mTileset;
+};
+
+static int tileId(const Cell &cell)
+{
+    return cell.isEmpty() ? -1 : cell.tile->id();
+}
+
+/**
+ * Writes a dummy map file, since the journal only looks at its size and
+ * modification time.
+ */
+static void writeMapFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+}
+
+void test_SaveJournal::init()
+{
+    QVERIFY(mDir.isValid());
+    mMapFileName = mDir.path() + QLatin1String("/map.tmx");
+    writeMapFile(mMapFileName, "map");
+    SaveJournal::discard(mMapFileName);
+
+    mTileset = Tileset::create(QLatin1String("tileset"), 32, 32);
+    for (int id = 0; id < 10; ++id)
+        mTileset->findOrCreateTile(id);
+}
+
+Map *test_SaveJournal::createMap() const
+{
+    Map *map = new Map(Map::Orthogonal, 10, 10, 32, 32);
+    map->addTileset(mTileset);
+    map->addLayer(new TileLayer(QLatin1String("layer"), 0, 0, 10, 10));
+    return map;
+}
+
+void test_SaveJournal::appendAndReplay()
+{
+    QScopedPointer<Map> map(createMap());
+    TileLayer *layer = tileLayer(map.data());
+    QHash<Layer*, QRegion> regions;
+
+    Cell flipped(mTileset->findTile(3));
+    flipped.flippedHorizontally = true;
+
+    layer->setCell(1, 1, Cell(mTileset->findTile(2)));
+    layer->setCell(2, 1, flipped);
+    regions.insert(layer, QRegion(1, 1, 2, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    // Erasing is recorded as well
+    layer->setCell(1, 1, Cell());
+    layer->setCell(5, 7, Cell(mTileset->findTile(9)));
+    regions.clear();
+    regions.insert(layer, QRegion(1, 1, 1, 1) + QRegion(5, 7, 1, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    QScopedPointer<Map> loaded(createMap());
+    QVERIFY(SaveJournal::replay(mMapFileName, loaded.data()));
+
+    const TileLayer *loadedLayer = tileLayer(loaded.data());
+    QCOMPARE(tileId(loadedLayer->cellAt(1, 1)), -1);
+    QCOMPARE(tileId(loadedLayer->cellAt(2, 1)), 3);
+    QVERIFY(loadedLayer->cellAt(2, 1).flippedHorizontally);
+    QCOMPARE(tileId(loadedLayer->cellAt(5, 7)), 9);
+    QCOMPARE(loadedLayer->region(), QRegion(2, 1, 1, 1) + QRegion(5, 7, 1, 1));
+}
+
+void test_SaveJournal::truncatedRecord()
+{
+    QScopedPointer<Map> map(createMap());
+    TileLayer *layer = tileLayer(map.data());
+    QHash<Layer*, QRegion> regions;
+
+    layer->setCell(0, 0, Cell(mTileset->findTile(1)));
+    regions.insert(layer, QRegion(0, 0, 1, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    layer->setCell(1, 0, Cell(mTileset->findTile(2)));
+    regions.insert(layer, QRegion(1, 0, 1, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    // Simulate a save that was interrupted while writing the second record
+    QFile journal(SaveJournal::fileName(mMapFileName));
+    QVERIFY(journal.resize(journal.size() - 2));
+
+    QScopedPointer<Map> loaded(createMap());
+    QVERIFY(SaveJournal::replay(mMapFileName, loaded.data()));
+    QCOMPARE(tileId(tileLayer(loaded.data())->cellAt(0, 0)), 1);
+    QCOMPARE(tileId(tileLayer(loaded.data())->cellAt(1, 0)), -1);
+
+    // Appending drops the incomplete record instead of writing after it
+    layer->setCell(2, 0, Cell(mTileset->findTile(3)));
+    regions.insert(layer, QRegion(2, 0, 1, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    loaded.reset(createMap());
+    QVERIFY(SaveJournal::replay(mMapFileName, loaded.data()));
+    QCOMPARE(tileId(tileLayer(loaded.data())->cellAt(0, 0)), 1);
+    QCOMPARE(tileId(tileLayer(loaded.data())->cellAt(2, 0)), 3);
+}
+
+void test_SaveJournal::tilesetGrew()
+{
+    SharedTileset second = Tileset::create(QLatin1String("second"), 32, 32);
+    second->findOrCreateTile(0);
+
+    QScopedPointer<Map> map(createMap());
+    map->addTileset(second);
+
+    TileLayer *layer = tileLayer(map.data());
+    layer->setCell(4, 4, Cell(second->findTile(0)));
+
+    QHash<Layer*, QRegion> regions;
+    regions.insert(layer, QRegion(4, 4, 1, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    // Growing the first tileset moves the global IDs of the second one
+    mTileset->findOrCreateTile(15);
+
+    QScopedPointer<Map> loaded(createMap());
+    loaded->addTileset(second);
+    QVERIFY(SaveJournal::replay(mMapFileName, loaded.data()));
+
+    const Cell cell = tileLayer(loaded.data())->cellAt(4, 4);
+    QCOMPARE(cell.tile->tileset(), second.data());
+    QCOMPARE(tileId(cell), 0);
+
+    // The new IDs can't be appended to the existing journal
+    QVERIFY(!SaveJournal::append(mMapFileName, map.data(), regions));
+}
+
+void test_SaveJournal::outdatedJournal()
+{
+    QScopedPointer<Map> map(createMap());
+    TileLayer *layer = tileLayer(map.data());
+    layer->setCell(0, 0, Cell(mTileset->findTile(1)));
+
+    QHash<Layer*, QRegion> regions;
+    regions.insert(layer, QRegion(0, 0, 1, 1));
+    QVERIFY(SaveJournal::append(mMapFileName, map.data(), regions));
+
+    // The map file was written by something else
+    writeMapFile(mMapFileName, "changed map");
+
+    QScopedPointer<Map> loaded(createMap());
+    QVERIFY(SaveJournal::replay(mMapFileName, loaded.data()));
+    QVERIFY(tileLayer(loaded.data())->isEmpty());
+}
+
+QTEST_MAIN(test_SaveJournal)
+#include "test_savejournal.moc"
@@ -1,4 +1,9 @@
 TEMPLATE=subdirs
 SUBDIRS = \
+    benchmarks \
     mapreader \
-    staggeredrenderer
+    orthogonalrenderer \
+    savejournal \
+    staggeredrenderer \
+    tilelayer \
+    tileset
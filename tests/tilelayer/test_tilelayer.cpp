@@ -0,0 +1,149 @@
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_TileLayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void setCell();
+    void iteration();
+    void cloneIsIndependent();
+    void resize();
+    void rotate();
+    void flip();
+
+private:
+    Cell cell(int id) const { return Cell(mTileset->findOrCreateTile(id)); }
+
+    SharedTileset mTileset;
+};
+
+/**
+ * Fills the layer with cells numbered by position, leaving every third
+ * cell empty.
+ */
+static void fill(TileLayer *layer, const SharedTileset &tileset)
+{
+    for (int y = 0; y < layer->height(); ++y)
+        for (int x = 0; x < layer->width(); ++x)
+            if ((x + y * layer->width()) % 3)
+                layer->setCell(x, y, Cell(tileset->findOrCreateTile(x + y * layer->width())));
+}
+
+static int tileId(const Cell &cell)
+{
+    return cell.isEmpty() ? -1 : cell.tile->id();
+}
+
+void test_TileLayer::initTestCase()
+{
+    mTileset = Tileset::create(QLatin1String("tileset"), 32, 32);
+}
+
+void test_TileLayer::cleanupTestCase()
+{
+    mTileset.clear();
+}
+
+void test_TileLayer::setCell()
+{
+    // Sizes that are not a multiple of the chunk size
+    TileLayer layer(QString(), 0, 0, 37, 21);
+    fill(&layer, mTileset);
+
+    for (int y = 0; y < layer.height(); ++y) {
+        for (int x = 0; x < layer.width(); ++x) {
+            const int index = x + y * layer.width();
+            QCOMPARE(tileId(layer.cellAt(x, y)), index % 3 ? index : -1);
+        }
+    }
+
+    QVERIFY(!layer.isEmpty());
+    layer.erase(QRegion(0, 0, layer.width(), layer.height()));
+    QVERIFY(layer.isEmpty());
+}
+
+void test_TileLayer::iteration()
+{
+    TileLayer layer(QString(), 0, 0, 19, 35);
+    fill(&layer, mTileset);
+
+    // Cells are visited row by row
+    int index = 0;
+    for (const Cell &cell : layer) {
+        QCOMPARE(tileId(cell), index % 3 ? index : -1);
+        ++index;
+    }
+    QCOMPARE(index, layer.width() * layer.height());
+
+    TileLayer empty(QString(), 0, 0, 0, 5);
+    QVERIFY(empty.begin() == empty.end());
+}
+
+void test_TileLayer::cloneIsIndependent()
+{
+    TileLayer layer(QString(), 0, 0, 40, 40);
+    fill(&layer, mTileset);
+
+    QScopedPointer<TileLayer> clone(static_cast<TileLayer*>(layer.clone()));
+    clone->setCell(20, 20, cell(1000));
+    layer.setCell(0, 0, cell(1001));
+
+    QCOMPARE(tileId(layer.cellAt(20, 20)), 20 + 20 * 40);
+    QCOMPARE(tileId(clone->cellAt(20, 20)), 1000);
+    QCOMPARE(tileId(layer.cellAt(0, 0)), 1001);
+    QCOMPARE(tileId(clone->cellAt(0, 0)), -1);
+
+    QCOMPARE(layer.computeDiffRegion(clone.data()),
+             QRegion(0, 0, 1, 1) + QRegion(20, 20, 1, 1));
+}
+
+void test_TileLayer::resize()
+{
+    TileLayer layer(QString(), 0, 0, 20, 20);
+    layer.setCell(19, 19, cell(1));
+    layer.setCell(5, 5, cell(2));
+
+    layer.resize(QSize(30, 18), QPoint(10, -4));
+
+    QCOMPARE(layer.size(), QSize(30, 18));
+    QCOMPARE(tileId(layer.cellAt(29, 15)), 1);
+    QCOMPARE(tileId(layer.cellAt(15, 1)), 2);
+    QCOMPARE(layer.region(), QRegion(29, 15, 1, 1) + QRegion(15, 1, 1, 1));
+}
+
+void test_TileLayer::rotate()
+{
+    TileLayer layer(QString(), 0, 0, 20, 3);
+    layer.setCell(19, 0, cell(1));
+
+    layer.rotate(RotateRight);
+
+    QCOMPARE(layer.size(), QSize(3, 20));
+    QCOMPARE(tileId(layer.cellAt(2, 19)), 1);
+    QVERIFY(layer.cellAt(2, 19).flippedAntiDiagonally);
+}
+
+void test_TileLayer::flip()
+{
+    TileLayer layer(QString(), 0, 0, 20, 20);
+    layer.setCell(1, 2, cell(1));
+
+    layer.flip(FlipHorizontally);
+
+    QCOMPARE(tileId(layer.cellAt(18, 2)), 1);
+    QVERIFY(layer.cellAt(18, 2).flippedHorizontally);
+    QCOMPARE(layer.region(), QRegion(18, 2, 1, 1));
+}
+
+QTEST_MAIN(test_TileLayer)
+#include "test_tilelayer.moc"
@@ -0,0 +1,103 @@
+#include "tile.h"
+#include "tileset.h"
+
+#include <QPainter>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_Tileset : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void reloadUnchangedImage();
+    void reloadChangedTile();
+    void reloadIndexedImage();
+    void reloadWithTransparentColor();
+};
+
+/**
+ * Returns a tileset image of 4 by 2 tiles of 8x8 pixels, each tile having
+ * a different color.
+ */
+static QImage tilesetImage()
+{
+    QImage image(32, 16, QImage::Format_ARGB32);
+
+    QPainter painter(&image);
+    for (int y = 0; y < 2; ++y)
+        for (int x = 0; x < 4; ++x)
+            painter.fillRect(x * 8, y * 8, 8, 8, QColor(x * 60, y * 120, 100));
+    painter.end();
+
+    return image;
+}
+
+void test_Tileset::reloadUnchangedImage()
+{
+    SharedTileset tileset = Tileset::create(QLatin1String("tiles"), 8, 8);
+    QVERIFY(tileset->loadFromImage(tilesetImage(), QLatin1String("tiles.png")));
+    QCOMPARE(tileset->tileCount(), 8);
+
+    const qint64 imageKey = tileset->findTile(0)->image().cacheKey();
+
+    QList<Tile*> changedTiles;
+    QVERIFY(tileset->reloadFromImage(tilesetImage(), changedTiles));
+    QVERIFY(changedTiles.isEmpty());
+    QCOMPARE(tileset->findTile(0)->image().cacheKey(), imageKey);
+}
+
+void test_Tileset::reloadChangedTile()
+{
+    SharedTileset tileset = Tileset::create(QLatin1String("tiles"), 8, 8);
+    QVERIFY(tileset->loadFromImage(tilesetImage(), QLatin1String("tiles.png")));
+
+    QImage image = tilesetImage();
+    image.setPixel(10, 12, qRgb(255, 255, 255));    // tile 5
+
+    QList<Tile*> changedTiles;
+    QVERIFY(tileset->reloadFromImage(image, changedTiles));
+    QCOMPARE(changedTiles.size(), 1);
+    QCOMPARE(changedTiles.first(), tileset->findTile(5));
+    QCOMPARE(changedTiles.first()->image().toImage().pixel(2, 4), qRgb(255, 255, 255));
+
+    // Reloading the same image again changes nothing
+    changedTiles.clear();
+    QVERIFY(tileset->reloadFromImage(image, changedTiles));
+    QVERIFY(changedTiles.isEmpty());
+}
+
+void test_Tileset::reloadIndexedImage()
+{
+    const QImage image = tilesetImage().convertToFormat(QImage::Format_Indexed8);
+
+    SharedTileset tileset = Tileset::create(QLatin1String("tiles"), 8, 8);
+    QVERIFY(tileset->loadFromImage(image, QLatin1String("tiles.png")));
+
+    // Changing only a color of the palette affects the tiles using it
+    QImage recolored = image;
+    const int colorIndex = recolored.pixelIndex(0, 0);
+    recolored.setColor(colorIndex, qRgb(255, 0, 0));
+
+    QList<Tile*> changedTiles;
+    QVERIFY(tileset->reloadFromImage(recolored, changedTiles));
+    QVERIFY(changedTiles.contains(tileset->findTile(0)));
+    QVERIFY(!changedTiles.contains(tileset->findTile(7)));
+}
+
+void test_Tileset::reloadWithTransparentColor()
+{
+    SharedTileset tileset = Tileset::create(QLatin1String("tiles"), 8, 8);
+    tileset->setTransparentColor(QColor(60, 120, 100));     // tile 5
+    QVERIFY(tileset->loadFromImage(tilesetImage(), QLatin1String("tiles.png")));
+    QCOMPARE(qAlpha(tileset->findTile(5)->image().toImage().pixel(0, 0)), 0);
+
+    // The hashes of the masked tile images match the loaded ones
+    QList<Tile*> changedTiles;
+    QVERIFY(tileset->reloadFromImage(tilesetImage(), changedTiles));
+    QVERIFY(changedTiles.isEmpty());
+}
+
+QTEST_MAIN(test_Tileset)
+#include "test_tileset.moc"